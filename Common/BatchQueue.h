@@ -0,0 +1,69 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _BATCHQUEUE_H
+#define _BATCHQUEUE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+// Hands results from a loader thread to the GUI thread in batches.  The loader pushes as it finds things,
+// the GUI takes whatever has arrived from a timer, so the window stays usable while a large tree loads
+template< typename T >
+class CBatchQueue
+{
+public:
+    void push( T && value )
+    {
+        std::lock_guard< std::mutex > lock( fMutex );
+        fItems.push_back( std::move( value ) );
+    }
+
+    // the oldest maxItems, in the order they were pushed
+    std::vector< T > take( size_t maxItems = std::numeric_limits< size_t >::max() )
+    {
+        std::lock_guard< std::mutex > lock( fMutex );
+        auto count = std::min( maxItems, fItems.size() );
+        std::vector< T > retVal;
+        retVal.reserve( count );
+        std::move( fItems.begin(), fItems.begin() + count, std::back_inserter( retVal ) );
+        fItems.erase( fItems.begin(), fItems.begin() + count );
+        return retVal;
+    }
+
+    bool empty() const
+    {
+        std::lock_guard< std::mutex > lock( fMutex );
+        return fItems.empty();
+    }
+private:
+    mutable std::mutex fMutex;
+    std::deque< T > fItems;
+};
+
+#endif
@@ -0,0 +1,235 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "Benchmark.h"
+#include "Trace.h"
+#include "ScanStats.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLineEdit>
+#include <QSaveFile>
+#include <QTemporaryDir>
+
+#include <iostream>
+#include <limits>
+#include <memory>
+
+CBenchmark::CBenchmark( const QString & description ) :
+    fEntriesOption( QStringList() << "e" << "entries", "Comma separated sizes of the synthetic libraries", "counts", "10000" ),
+    fIterationsOption( QStringList() << "i" << "iterations", "Number of times each case is run per library", "count", "3" ),
+    fDirOption( QStringList() << "d" << "dir", "Directory the libraries are generated in and kept for later runs, defaults to a temporary directory", "dir" ),
+    fSeedOption( "seed", "Seed for the library generator", "seed", "1" ),
+    fDepthOption( "depth", "Number of category directory levels", "levels", "2" ),
+    fIDShareOption( "id-share", "Share of movie folders with a [tmdbid=] in their name", "share", "0.75" ),
+    fNoNFOOption( "no-nfo", "Do not write NFO files" ),
+    fNoM3UOption( "no-m3u", "Do not write M3U playlists" ),
+    fNoNoiseOption( "no-noise", "Do not write Extras/Subs/Featurettes folders" ),
+    fTraceOption( "trace", "Write a Chrome trace of the cases to the file", "file" ),
+    fStatsOption( "stats", "Write the scan counters of each case to the file as JSON", "file" )
+{
+    fCmdLine.setApplicationDescription( description );
+    fCmdLine.addHelpOption();
+    fCmdLine.addOption( fEntriesOption );
+    fCmdLine.addOption( fIterationsOption );
+    fCmdLine.addOption( fDirOption );
+    fCmdLine.addOption( fSeedOption );
+    fCmdLine.addOption( fDepthOption );
+    fCmdLine.addOption( fIDShareOption );
+    fCmdLine.addOption( fNoNFOOption );
+    fCmdLine.addOption( fNoM3UOption );
+    fCmdLine.addOption( fNoNoiseOption );
+    fCmdLine.addOption( fTraceOption );
+    fCmdLine.addOption( fStatsOption );
+}
+
+void CBenchmark::process( const QCoreApplication & appl )
+{
+    fCmdLine.process( appl );
+
+    fEntries.clear();
+    for ( auto && ii : fCmdLine.value( fEntriesOption ).split( ",", Qt::SkipEmptyParts ) )
+    {
+        auto numEntries = ii.trimmed().toInt();
+        if ( numEntries > 0 )
+            fEntries.push_back( numEntries );
+    }
+    if ( fEntries.empty() )
+        fEntries.push_back( 10000 );
+
+    fIterations = std::max( 1, fCmdLine.value( fIterationsOption ).toInt() );
+    fBaseDir = fCmdLine.value( fDirOption );
+    fTraceFile = fCmdLine.value( fTraceOption );
+    fStatsFile = fCmdLine.value( fStatsOption );
+
+    fOptions.fSeed = fCmdLine.value( fSeedOption ).toUInt();
+    fOptions.fDepth = std::max( 0, fCmdLine.value( fDepthOption ).toInt() );
+    fOptions.fIDShare = fCmdLine.value( fIDShareOption ).toDouble();
+    fOptions.fNFO = !fCmdLine.isSet( fNoNFOOption );
+    fOptions.fM3U = !fCmdLine.isSet( fNoM3UOption );
+    if ( fCmdLine.isSet( fNoNoiseOption ) )
+        fOptions.fNoiseShare = 0.0;
+}
+
+void CBenchmark::setHeadless()
+{
+    if ( qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ) )
+        qputenv( "QT_QPA_PLATFORM", "offscreen" );
+}
+
+bool CBenchmark::setDirectory( QWidget * window, const QString & objectName, const QString & dir, QString & errorMsg )
+{
+    auto lineEdit = window->findChild< QLineEdit * >( objectName );
+    if ( !lineEdit )
+    {
+        errorMsg = QString( "Could not find the '%1' line edit" ).arg( objectName );
+        return false;
+    }
+    lineEdit->blockSignals( true );
+    lineEdit->setText( dir );
+    lineEdit->blockSignals( false );
+    return true;
+}
+
+void CBenchmark::addCase( const QString & name, TCaseFunc func )
+{
+    fCases.push_back( { name, func } );
+}
+
+bool CBenchmark::prepareLibrary( int numEntries, QString & rootDir, QString & errorMsg )
+{
+    auto options = fOptions;
+    options.fEntries = numEntries;
+    if ( CSyntheticLibrary::isGenerated( rootDir, options ) )
+    {
+        std::cout << "Reusing library '" << qPrintable( rootDir ) << "'" << std::endl;
+        return true;
+    }
+
+    if ( QDir( rootDir ).exists() && !QDir( rootDir ).removeRecursively() )
+    {
+        errorMsg = QString( "Could not remove the previous library '%1'" ).arg( rootDir );
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    CSyntheticLibrary library( options );
+    if ( !library.generate( rootDir, errorMsg ) )
+        return false;
+    std::cout << "Generated " << library.numEntries() << " entries (" << library.numMovies() << " movies) in " << timer.elapsed() << "ms" << std::endl;
+    return true;
+}
+
+int CBenchmark::run()
+{
+    std::unique_ptr< QTemporaryDir > tmpDir;
+    auto baseDir = fBaseDir;
+    if ( baseDir.isEmpty() )
+    {
+        tmpDir = std::make_unique< QTemporaryDir >();
+        if ( !tmpDir->isValid() )
+        {
+            std::cerr << "Could not create temporary directory" << std::endl;
+            return 1;
+        }
+        baseDir = tmpDir->path();
+    }
+
+    QJsonArray statsRuns;
+
+    for ( auto && numEntries : fEntries )
+    {
+        auto rootDir = QDir( baseDir ).absoluteFilePath( QString( "Library_%1" ).arg( numEntries ) );
+        QString errorMsg;
+        if ( !prepareLibrary( numEntries, rootDir, errorMsg ) )
+        {
+            std::cerr << qPrintable( errorMsg ) << std::endl;
+            return 1;
+        }
+
+        if ( !fTraceFile.isEmpty() )
+            NTrace::enable();
+
+        for ( auto && ii : fCases )
+        {
+            qint64 total = 0;
+            qint64 best = std::numeric_limits< qint64 >::max();
+            NScanStats::SStats stats;
+            for ( int jj = 0; jj < fIterations; ++jj )
+            {
+                NScanStats::reset();
+                QElapsedTimer timer;
+                timer.start();
+                if ( !ii.fFunc( rootDir, errorMsg ) )
+                {
+                    std::cerr << qPrintable( ii.fName ) << ": " << qPrintable( errorMsg ) << std::endl;
+                    return 1;
+                }
+                auto nsecs = std::max< qint64 >( 1, timer.nsecsElapsed() );
+                total += nsecs;
+                best = std::min( best, nsecs );
+                stats = NScanStats::collect();
+            }
+            std::cout << numEntries << " entries, " << qPrintable( ii.fName ) << ": "
+                << ( best / 1000000.0 ) << "ms best, "
+                << ( total / fIterations / 1000000.0 ) << "ms average, "
+                << static_cast< qint64 >( numEntries * 1e9 / best ) << " entries/s" << std::endl;
+
+            // the counters of the last iteration, the tool windows reset them when a load starts
+            QJsonObject statsRun;
+            statsRun[ "entries" ] = numEntries;
+            statsRun[ "case" ] = ii.fName;
+            statsRun[ "iterations" ] = fIterations;
+            statsRun[ "bestMS" ] = best / 1000000.0;
+            statsRun[ "averageMS" ] = total / fIterations / 1000000.0;
+            statsRun[ "stats" ] = stats.toJson();
+            statsRuns.append( statsRun );
+        }
+    }
+
+    if ( !fTraceFile.isEmpty() )
+    {
+        QString errorMsg;
+        if ( !NTrace::write( fTraceFile, errorMsg ) )
+        {
+            std::cerr << qPrintable( errorMsg ) << std::endl;
+            return 1;
+        }
+    }
+
+    if ( !fStatsFile.isEmpty() )
+    {
+        QSaveFile file( fStatsFile );
+        if ( !file.open( QSaveFile::WriteOnly ) || ( file.write( QJsonDocument( statsRuns ).toJson() ) < 0 ) || !file.commit() )
+        {
+            std::cerr << "Could not write '" << qPrintable( fStatsFile ) << "': " << qPrintable( file.errorString() ) << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
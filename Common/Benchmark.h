@@ -0,0 +1,121 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _BENCHMARK_H
+#define _BENCHMARK_H
+
+#include "SyntheticLibrary.h"
+
+#include <QCommandLineParser>
+#include <QEventLoop>
+#include <QString>
+#include <QTimer>
+#include <functional>
+#include <vector>
+
+class QCoreApplication;
+class QWidget;
+
+// Shared driver for the <Tool>Bench targets.  Generates (or reuses) a synthetic library per requested size
+// and times each registered case against it, reporting the best and average time and entries/sec
+//
+// --entries 10000,100000,1000000 --iterations 3 --dir <path> keeps the trees between runs, --trace out.json
+// records the traced scopes of every case and --stats out.json the scan counters of every case
+class CBenchmark
+{
+public:
+    // returns false and sets errorMsg when the case fails, the run then stops
+    using TCaseFunc = std::function< bool( const QString & rootDir, QString & errorMsg ) >;
+
+    CBenchmark( const QString & description );
+
+    // extra, tool specific options must be added before process is called
+    QCommandLineParser & cmdLine() { return fCmdLine; }
+    void process( const QCoreApplication & appl );
+
+    void addCase( const QString & name, TCaseFunc func );
+    int run();
+
+    const std::vector< int > & entries() const { return fEntries; }
+    int iterations() const { return fIterations; }
+    const SSyntheticLibraryOptions & libraryOptions() const { return fOptions; }
+
+    // must be called before the application is created, the windows are never shown
+    static void setHeadless();
+    // sets the named line edit of a tool window without triggering its delayed auto load
+    static bool setDirectory( QWidget * window, const QString & objectName, const QString & dir, QString & errorMsg );
+private:
+    bool prepareLibrary( int numEntries, QString & rootDir, QString & errorMsg );
+
+    struct SCase
+    {
+        QString fName;
+        TCaseFunc fFunc;
+    };
+
+    QCommandLineParser fCmdLine;
+    QCommandLineOption fEntriesOption;
+    QCommandLineOption fIterationsOption;
+    QCommandLineOption fDirOption;
+    QCommandLineOption fSeedOption;
+    QCommandLineOption fDepthOption;
+    QCommandLineOption fIDShareOption;
+    QCommandLineOption fNoNFOOption;
+    QCommandLineOption fNoM3UOption;
+    QCommandLineOption fNoNoiseOption;
+    QCommandLineOption fTraceOption;
+    QCommandLineOption fStatsOption;
+
+    std::vector< SCase > fCases;
+    std::vector< int > fEntries;
+    int fIterations{ 3 };
+    QString fBaseDir;
+    QString fTraceFile;
+    QString fStatsFile;
+    SSyntheticLibraryOptions fOptions;
+};
+
+// Calls start and runs the event loop until the object emits the signal, for timing the asynchronous loaders.
+// A loader that never finishes fails the case once timeoutMS has passed instead of hanging the run
+template< typename TObject, typename TSignal >
+bool runUntilSignal( TObject * object, TSignal signal, const std::function< void() > & start, QString & errorMsg, int timeoutMS = 30 * 60 * 1000 )
+{
+    QEventLoop loop;
+    bool finished = false;
+    auto connection = QObject::connect( object, signal, &loop, [ &finished, &loop ]() { finished = true; loop.quit(); } );
+    QTimer deadline;
+    deadline.setSingleShot( true );
+    QObject::connect( &deadline, &QTimer::timeout, &loop, &QEventLoop::quit );
+    start();
+    if ( !finished )
+    {
+        deadline.start( timeoutMS );
+        loop.exec();
+    }
+    QObject::disconnect( connection );
+    if ( !finished )
+        errorMsg = QString( "Did not finish within %1 seconds" ).arg( timeoutMS / 1000 );
+    return finished;
+}
+
+#endif
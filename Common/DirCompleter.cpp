@@ -0,0 +1,155 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "DirCompleter.h"
+#include "Trace.h"
+
+#include <QDir>
+#include <QLineEdit>
+#include <QStringListModel>
+#include <QThread>
+
+#include <algorithm>
+
+class CDirLister : public QThread
+{
+public:
+    CDirLister( const QString & dir, QObject * parent ) :
+        QThread( parent ),
+        fDir( dir )
+    {
+    }
+
+    void run() override
+    {
+        TRACE_SCOPE( "scan", "CDirLister::run" );
+        fNames = QDir( fDir ).entryList( QDir::AllDirs | QDir::NoDotAndDotDot, QDir::Name | QDir::IgnoreCase );
+    }
+
+    QString fDir;
+    QStringList fNames;
+};
+
+CDirCompleter::CDirCompleter( QObject * parent /*= nullptr*/ ) :
+    QCompleter( parent )
+{
+    fModel = new QStringListModel( this );
+    setModel( fModel );
+    setCompletionMode( QCompleter::PopupCompletion );
+    setCaseSensitivity( Qt::CaseInsensitive );
+}
+
+CDirCompleter::~CDirCompleter()
+{
+    if ( !fLister )
+        return;
+
+    // a listing on a slow share is not waited for, the thread cleans itself up when it is done
+    disconnect( fLister, nullptr, this, nullptr );
+    fLister->setParent( nullptr );
+    connect( fLister, &QThread::finished, fLister, &QObject::deleteLater );
+    fLister = nullptr;
+}
+
+void CDirCompleter::addLineEdit( QLineEdit * lineEdit )
+{
+    lineEdit->setCompleter( this );
+    connect( lineEdit, &QLineEdit::textEdited, this, &CDirCompleter::slotTextEdited );
+}
+
+void CDirCompleter::slotTextEdited( const QString & text )
+{
+    auto pos = std::max( text.lastIndexOf( '/' ), text.lastIndexOf( '\\' ) );
+    auto prefix = text.left( pos + 1 );
+    if ( prefix == fPrefix )
+        return; // still in the same directory, the completer filters what is already listed
+
+    fPrefix = prefix;
+    fDir = prefix.isEmpty() ? QString() : QDir::cleanPath( QDir::fromNativeSeparators( prefix ) );
+    showListing( QStringList() );
+    if ( fDir.isEmpty() )
+        return;
+
+    if ( auto names = cachedListing( fDir ) )
+    {
+        showListing( *names );
+        return;
+    }
+
+    // only one listing at a time, when it finishes the directory typed by then is listed
+    if ( !fLister )
+        startListing( fDir );
+}
+
+const QStringList * CDirCompleter::cachedListing( const QString & dir )
+{
+    for ( auto ii = fCache.begin(); ii != fCache.end(); ++ii )
+    {
+        if ( ( *ii ).first != dir )
+            continue;
+        fCache.splice( fCache.begin(), fCache, ii );
+        return &fCache.front().second;
+    }
+    return nullptr;
+}
+
+void CDirCompleter::startListing( const QString & dir )
+{
+    fLister = new CDirLister( dir, this );
+    connect( fLister, &QThread::finished, this, &CDirCompleter::slotListingFinished );
+    fLister->start();
+}
+
+void CDirCompleter::slotListingFinished()
+{
+    if ( !fLister || ( sender() != fLister ) )
+        return;
+
+    auto dir = fLister->fDir;
+    auto names = std::move( fLister->fNames );
+    fLister->deleteLater();
+    fLister = nullptr;
+
+    fCache.emplace_front( dir, std::move( names ) );
+    if ( fCache.size() > kCacheSize )
+        fCache.pop_back();
+
+    if ( dir == fDir )
+    {
+        showListing( fCache.front().second );
+        if ( widget() && widget()->hasFocus() )
+            complete();
+    }
+    else if ( !fDir.isEmpty() && !cachedListing( fDir ) )
+        startListing( fDir );
+}
+
+void CDirCompleter::showListing( const QStringList & names )
+{
+    // full paths in the separator style being typed, so they match the text as it is
+    QStringList paths;
+    paths.reserve( names.size() );
+    for ( auto && ii : names )
+        paths << fPrefix + ii;
+    fModel->setStringList( paths );
+}
@@ -0,0 +1,66 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _DIRCOMPLETER_H
+#define _DIRCOMPLETER_H
+
+#include <QCompleter>
+#include <QStringList>
+#include <cstddef>
+#include <list>
+#include <utility>
+
+class QLineEdit;
+class QStringListModel;
+class CDirLister;
+
+// Path completer for the directory line edits.  Unlike a QFileSystemModel it does nothing until the user
+// types, then lists only the directory being typed in, on a worker thread.  The last few listings are kept
+// so moving back and forth between directories doesn't go back to the disk
+class CDirCompleter : public QCompleter
+{
+    Q_OBJECT
+public:
+    CDirCompleter( QObject * parent = nullptr );
+    ~CDirCompleter();
+
+    // one completer can serve several line edits
+    void addLineEdit( QLineEdit * lineEdit );
+
+    static constexpr size_t kCacheSize = 16;
+private Q_SLOTS:
+    void slotTextEdited( const QString & text );
+    void slotListingFinished();
+private:
+    void startListing( const QString & dir );
+    void showListing( const QStringList & names );
+    const QStringList * cachedListing( const QString & dir );
+
+    QStringListModel * fModel{ nullptr };
+    CDirLister * fLister{ nullptr };
+    QString fPrefix; // what was typed up to and including the last separator
+    QString fDir; // the directory fPrefix names
+    std::list< std::pair< QString, QStringList > > fCache; // most recently used first
+};
+
+#endif
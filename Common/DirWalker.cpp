@@ -0,0 +1,156 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "DirWalker.h"
+#include "ScanStats.h"
+
+#include <QFile>
+#include <QDir>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+namespace NDirWalker
+{
+#ifdef Q_OS_WIN
+    bool readDir( const QString & dirPath, std::vector< SEntry > & entries, const TNeedStatFunc & /*needStat*/ )
+    {
+        entries.clear();
+        // the extended length form, so paths past MAX_PATH can still be listed
+        auto nativePath = QDir::toNativeSeparators( QDir::cleanPath( QDir( dirPath ).absolutePath() ) );
+        if ( nativePath.startsWith( "\\\\" ) ) // \\server\share
+            nativePath = "\\\\?\\UNC\\" + nativePath.mid( 2 );
+        else
+            nativePath = "\\\\?\\" + nativePath;
+        auto pattern = ( nativePath.endsWith( '\\' ) ? ( nativePath + "*" ) : ( nativePath + "\\*" ) ).toStdWString();
+        WIN32_FIND_DATAW data;
+        auto handle = FindFirstFileExW( pattern.c_str(), FindExInfoBasic, &data, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH );
+        if ( handle == INVALID_HANDLE_VALUE )
+            return false;
+        NScanStats::add( NScanStats::eDirsRead );
+
+        do
+        {
+            auto name = QString::fromWCharArray( data.cFileName );
+            if ( ( name == "." ) || ( name == ".." ) || ( data.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN ) )
+                continue;
+
+            SEntry entry;
+            entry.fName = name;
+            // other reparse points, dedup and cloud placeholders among them, are ordinary files and directories
+            entry.fIsSymLink = ( data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT ) && ( ( data.dwReserved0 == IO_REPARSE_TAG_SYMLINK ) || ( data.dwReserved0 == IO_REPARSE_TAG_MOUNT_POINT ) );
+            entry.fIsDir = !entry.fIsSymLink && ( data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY );
+            entry.fIsFile = !entry.fIsSymLink && !entry.fIsDir;
+            entry.fSize = ( static_cast< qint64 >( data.nFileSizeHigh ) << 32 ) | data.nFileSizeLow;
+            // FILETIME counts 100ns intervals from 1601
+            auto fileTime = ( static_cast< qint64 >( data.ftLastWriteTime.dwHighDateTime ) << 32 ) | data.ftLastWriteTime.dwLowDateTime;
+            entry.fModified = ( fileTime - 116444736000000000LL ) / 10000;
+            entries.push_back( std::move( entry ) );
+        }
+        while ( FindNextFileW( handle, &data ) );
+        FindClose( handle );
+        return true;
+    }
+#else
+    bool readDir( const QString & dirPath, std::vector< SEntry > & entries, const TNeedStatFunc & needStat )
+    {
+        entries.clear();
+        auto dir = opendir( QFile::encodeName( dirPath ).constData() );
+        if ( !dir )
+            return false;
+        NScanStats::add( NScanStats::eDirsRead );
+
+        auto fd = dirfd( dir );
+        while ( auto dirEnt = readdir( dir ) )
+        {
+            // hidden on POSIX, which also covers "." and ".."
+            if ( dirEnt->d_name[ 0 ] == '.' )
+                continue;
+
+            SEntry entry;
+            entry.fName = QFile::decodeName( dirEnt->d_name );
+            entry.fInode = dirEnt->d_ino;
+            bool typeKnown = true;
+            switch ( dirEnt->d_type )
+            {
+                case DT_DIR:
+                    entry.fIsDir = true;
+                    break;
+                case DT_REG:
+                    entry.fIsFile = true;
+                    break;
+                case DT_LNK:
+                    entry.fIsSymLink = true;
+                    break;
+                case DT_UNKNOWN:
+                    typeKnown = false;
+                    break;
+                default: // devices, pipes and sockets are none of the three
+                    break;
+            }
+
+            if ( !typeKnown || ( needStat && needStat( entry ) ) )
+            {
+                struct stat st;
+                NScanStats::add( NScanStats::eEntriesStated );
+                if ( fstatat( fd, dirEnt->d_name, &st, AT_SYMLINK_NOFOLLOW ) == 0 )
+                {
+                    entry.fIsDir = S_ISDIR( st.st_mode );
+                    entry.fIsFile = S_ISREG( st.st_mode );
+                    entry.fIsSymLink = S_ISLNK( st.st_mode );
+                    entry.fSize = st.st_size;
+#if defined( Q_OS_MACOS )
+                    entry.fModified = static_cast< qint64 >( st.st_mtimespec.tv_sec ) * 1000 + st.st_mtimespec.tv_nsec / 1000000;
+#else
+                    entry.fModified = static_cast< qint64 >( st.st_mtim.tv_sec ) * 1000 + st.st_mtim.tv_nsec / 1000000;
+#endif
+                }
+            }
+            entries.push_back( std::move( entry ) );
+        }
+        closedir( dir );
+        return true;
+    }
+#endif
+
+    CNameFilter::CNameFilter( const QStringList & filters )
+    {
+        for ( auto && ii : filters )
+            fRegExps.emplace_back( QRegularExpression::wildcardToRegularExpression( ii ), QRegularExpression::CaseInsensitiveOption );
+    }
+
+    bool CNameFilter::match( const QString & name ) const
+    {
+        for ( auto && ii : fRegExps )
+        {
+            NScanStats::add( NScanStats::eRegexEvals );
+            if ( ii.match( name ).hasMatch() )
+                return true;
+        }
+        return false;
+    }
+}
@@ -0,0 +1,77 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _DIRWALKER_H
+#define _DIRWALKER_H
+
+#include <QString>
+#include <QStringList>
+#include <QRegularExpression>
+#include <functional>
+#include <vector>
+
+// Directory listing that keeps what the OS hands back with each name, so a walk doesn't stat an entry again
+// to find out what it is
+//
+//     std::vector< NDirWalker::SEntry > entries;
+//     NDirWalker::readDir( dirPath, entries, []( const NDirWalker::SEntry & entry ) { return entry.fIsFile; } );
+//
+// On Windows the listing already carries the type, size and modification time.  On POSIX readdir gives the
+// type and inode, the size and time take an fstatat against the open directory, made only for the entries
+// the caller asks for (and for any whose type the file system didn't report)
+namespace NDirWalker
+{
+    struct SEntry
+    {
+        QString fName;
+        bool fIsDir{ false };
+        bool fIsFile{ false };
+        bool fIsSymLink{ false };
+        quint64 fInode{ 0 }; // 0 when the OS doesn't report one
+        qint64 fSize{ -1 }; // -1 when not known
+        qint64 fModified{ -1 }; // msecs since the epoch, -1 when not known
+
+        bool hasStat() const { return fModified >= 0; }
+    };
+
+    // called once the type is known, returning true fills in the size and time
+    using TNeedStatFunc = std::function< bool( const SEntry & entry ) >;
+
+    // The entries of dirPath, without "." and ".." or hidden entries, the same set QDir lists without QDir::Hidden.
+    // Symbolic links are returned as such and never followed.  Returns false when the directory can't be read
+    bool readDir( const QString & dirPath, std::vector< SEntry > & entries, const TNeedStatFunc & needStat = {} );
+
+    inline QString filePath( const QString & dirPath, const SEntry & entry ) { return dirPath.endsWith( '/' ) ? ( dirPath + entry.fName ) : ( dirPath + "/" + entry.fName ); }
+
+    // QDir style wildcards, "*.mkv", matched case insensitively.  Compiled once, unlike QDir::match
+    class CNameFilter
+    {
+    public:
+        CNameFilter( const QStringList & filters = {} );
+        bool isEmpty() const { return fRegExps.empty(); }
+        bool match( const QString & name ) const;
+    private:
+        std::vector< QRegularExpression > fRegExps;
+    };
+}
+
+#endif
@@ -0,0 +1,266 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Log.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QThread>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace NLog
+{
+    namespace
+    {
+        const char * levelName( ELevel level )
+        {
+            switch ( level )
+            {
+                case eTrace: return "TRACE";
+                case eDebug: return "DEBUG";
+                case eInfo: return "INFO";
+                case eWarning: return "WARNING";
+                case eError: return "ERROR";
+                default: return "OFF";
+            }
+        }
+
+        bool levelFromName( const QString & name, ELevel & level )
+        {
+            for ( int ii = eTrace; ii <= eOff; ++ii )
+            {
+                if ( name.compare( levelName( static_cast< ELevel >( ii ) ), Qt::CaseInsensitive ) == 0 )
+                {
+                    level = static_cast< ELevel >( ii );
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        struct SRegistry
+        {
+            SRegistry()
+            {
+                auto env = qEnvironmentVariable( "MEDIATOOLS_LOG" );
+                for ( auto && ii : env.split( ",", Qt::SkipEmptyParts ) )
+                {
+                    auto pos = ii.indexOf( '=' );
+                    ELevel level;
+                    if ( ( pos > 0 ) && levelFromName( ii.mid( pos + 1 ).trimmed(), level ) )
+                        fLevels[ ii.left( pos ).trimmed() ] = level;
+                }
+            }
+
+            void apply( CCategory * category ) const
+            {
+                auto pos = fLevels.find( QString::fromUtf8( category->name() ) );
+                if ( pos == fLevels.end() )
+                    pos = fLevels.find( "*" );
+                if ( pos != fLevels.end() )
+                    category->setLevel( ( *pos ).second );
+            }
+
+            std::mutex fMutex;
+            std::vector< CCategory * > fCategories;
+            std::map< QString, ELevel > fLevels;
+        };
+
+        SRegistry & registry()
+        {
+            static SRegistry sRegistry;
+            return sRegistry;
+        }
+
+        struct SRecord
+        {
+            const char * fCategory{ nullptr }; // the literal, the category itself may be gone by the time it is written
+            ELevel fLevel{ eOff };
+            qint64 fTime{ 0 };
+            quintptr fThread{ 0 };
+            QString fMsg;
+        };
+
+        // bounded ring of pending messages, drained by a single writer thread.  When it is full new
+        // messages are counted and dropped rather than blocking the hot path
+        class CWriter
+        {
+        public:
+            static CWriter & instance()
+            {
+                static CWriter sWriter;
+                return sWriter;
+            }
+
+            ~CWriter()
+            {
+                {
+                    std::lock_guard< std::mutex > lock( fMutex );
+                    fStop = true;
+                }
+                fPending.notify_one();
+                if ( fThread.joinable() )
+                    fThread.join();
+            }
+
+            void push( SRecord && record )
+            {
+                std::lock_guard< std::mutex > lock( fMutex );
+                if ( fCount == fRing.size() )
+                {
+                    fDropped++;
+                    return;
+                }
+                fRing[ ( fHead + fCount ) % fRing.size() ] = std::move( record );
+                fCount++;
+                if ( !fThread.joinable() )
+                    fThread = std::thread( &CWriter::run, this );
+                fPending.notify_one();
+            }
+
+            void flush()
+            {
+                std::unique_lock< std::mutex > lock( fMutex );
+                fIdle.wait( lock, [ this ]() { return !fCount && !fWriting; } );
+            }
+        private:
+            CWriter() :
+                fRing( 8192 )
+            {
+            }
+
+            void run()
+            {
+                std::vector< SRecord > batch;
+                std::unique_lock< std::mutex > lock( fMutex );
+                while ( true )
+                {
+                    fPending.wait( lock, [ this ]() { return fStop || fCount; } );
+                    if ( !fCount && fStop )
+                        break;
+
+                    batch.clear();
+                    for ( ; fCount; --fCount, fHead = ( fHead + 1 ) % fRing.size() )
+                        batch.push_back( std::move( fRing[ fHead ] ) );
+                    auto dropped = fDropped;
+                    fDropped = 0;
+                    fWriting = true;
+                    lock.unlock();
+
+                    QByteArray out;
+                    for ( auto && ii : batch )
+                    {
+                        out += QDateTime::fromMSecsSinceEpoch( ii.fTime ).toString( Qt::ISODateWithMs ).toUtf8() + " " + levelName( ii.fLevel ) + " " + ii.fCategory
+                            + " [" + QByteArray::number( static_cast< qulonglong >( ii.fThread ), 16 ) + "] " + ii.fMsg.toUtf8() + "\n";
+                    }
+                    if ( dropped )
+                        out += QByteArray::number( static_cast< qulonglong >( dropped ) ) + " log messages dropped\n";
+                    fwrite( out.constData(), 1, out.size(), stderr );
+                    fflush( stderr );
+
+                    lock.lock();
+                    fWriting = false;
+                    fIdle.notify_all();
+                }
+            }
+
+            std::mutex fMutex;
+            std::condition_variable fPending;
+            std::condition_variable fIdle;
+            std::vector< SRecord > fRing;
+            size_t fHead{ 0 };
+            size_t fCount{ 0 };
+            size_t fDropped{ 0 };
+            bool fWriting{ false };
+            bool fStop{ false };
+            std::thread fThread;
+        };
+    }
+
+    CCategory::CCategory( const char * name, ELevel defaultLevel /*= eWarning*/ ) :
+        fName( name ),
+        fLevel( defaultLevel )
+    {
+        auto && reg = registry();
+        std::lock_guard< std::mutex > lock( reg.fMutex );
+        reg.fCategories.push_back( this );
+        reg.apply( this );
+    }
+
+    CCategory::~CCategory()
+    {
+        auto && reg = registry();
+        std::lock_guard< std::mutex > lock( reg.fMutex );
+        reg.fCategories.erase( std::remove( reg.fCategories.begin(), reg.fCategories.end(), this ), reg.fCategories.end() );
+    }
+
+    void write( const CCategory & category, ELevel level, QString && msg )
+    {
+        SRecord record;
+        record.fCategory = category.name();
+        record.fLevel = level;
+        record.fTime = QDateTime::currentMSecsSinceEpoch();
+        record.fThread = reinterpret_cast< quintptr >( QThread::currentThreadId() );
+        record.fMsg = std::move( msg );
+        CWriter::instance().push( std::move( record ) );
+    }
+
+    void flush()
+    {
+        CWriter::instance().flush();
+    }
+
+    void setLevels( const QString & spec )
+    {
+        auto && reg = registry();
+        std::lock_guard< std::mutex > lock( reg.fMutex );
+        for ( auto && ii : spec.split( ",", Qt::SkipEmptyParts ) )
+        {
+            auto pos = ii.indexOf( '=' );
+            ELevel level;
+            if ( ( pos > 0 ) && levelFromName( ii.mid( pos + 1 ).trimmed(), level ) )
+                reg.fLevels[ ii.left( pos ).trimmed() ] = level;
+        }
+        for ( auto && ii : reg.fCategories )
+            reg.apply( ii );
+    }
+
+    void initFromArguments( QCoreApplication & appl )
+    {
+        auto args = appl.arguments();
+        for ( int ii = 1; ii < args.size(); ++ii )
+        {
+            if ( args[ ii ].startsWith( "--log=" ) )
+                setLevels( args[ ii ].mid( 6 ) );
+            else if ( ( args[ ii ] == "--log" ) && ( ( ii + 1 ) < args.size() ) )
+                setLevels( args[ ++ii ] );
+        }
+        QObject::connect( &appl, &QCoreApplication::aboutToQuit, []() { flush(); } );
+    }
+}
@@ -0,0 +1,113 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _LOG_H
+#define _LOG_H
+
+#include <QString>
+#include <QVariant>
+#include <atomic>
+#include <type_traits>
+
+class QCoreApplication;
+
+// Categorized logging for the hot paths
+//
+//     static NLog::CCategory sLog( "dirmodel" );
+//     LOG_TRACE( sLog, "Checking to see if %1 should be shown", idx.data() );
+//
+// Levels below MEDIATOOLS_LOG_MIN_LEVEL are removed by the compiler, debug builds keep everything and release
+// builds start at info.  The rest cost a load and a branch until their category is turned on, the arguments
+// are only formatted after that.  Messages are queued in a ring buffer and written to stderr by a background thread
+//
+// Categories are turned on with MEDIATOOLS_LOG="dirmodel=trace,load=debug" or "--log dirmodel=trace", trace
+// and debug in a release build need it configured with -DMEDIATOOLS_LOG_MIN_LEVEL=0
+namespace NLog
+{
+    enum ELevel
+    {
+        eTrace,
+        eDebug,
+        eInfo,
+        eWarning,
+        eError,
+        eOff
+    };
+
+    class CCategory
+    {
+    public:
+        CCategory( const char * name, ELevel defaultLevel = eWarning );
+        ~CCategory();
+        CCategory( const CCategory & ) = delete;
+        CCategory & operator=( const CCategory & ) = delete;
+
+        const char * name() const { return fName; }
+        bool isEnabled( ELevel level ) const { return level >= fLevel.load( std::memory_order_relaxed ); }
+        void setLevel( ELevel level ) { fLevel.store( level, std::memory_order_relaxed ); }
+    private:
+        const char * fName;
+        std::atomic< int > fLevel;
+    };
+
+    void write( const CCategory & category, ELevel level, QString && msg );
+    // waits until everything queued so far is written
+    void flush();
+
+    // "name=level,..." from MEDIATOOLS_LOG and then --log
+    void setLevels( const QString & spec );
+    void initFromArguments( QCoreApplication & appl );
+
+    inline QString toString( const QString & value ) { return value; }
+    inline QString toString( const char * value ) { return QString::fromUtf8( value ); }
+    inline QString toString( const QVariant & value ) { return value.toString(); }
+    inline QString toString( bool value ) { return value ? "true" : "false"; }
+    template< typename T >
+    typename std::enable_if< std::is_arithmetic< T >::value, QString >::type toString( T value ) { return QString::number( value ); }
+
+    inline QString format( const char * fmt ) { return QString::fromUtf8( fmt ); }
+    template< typename... TArgs >
+    QString format( const char * fmt, const TArgs &... args ) { return QString::fromUtf8( fmt ).arg( toString( args )... ); }
+}
+
+#ifndef MEDIATOOLS_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define MEDIATOOLS_LOG_MIN_LEVEL 2 // NLog::eInfo
+#else
+#define MEDIATOOLS_LOG_MIN_LEVEL 0 // NLog::eTrace
+#endif
+#endif
+
+#define LOG_AT( category, level, ... ) \
+    do \
+    { \
+        if ( ( ( level ) >= MEDIATOOLS_LOG_MIN_LEVEL ) && ( category ).isEnabled( level ) ) \
+            NLog::write( ( category ), ( level ), NLog::format( __VA_ARGS__ ) ); \
+    } while ( 0 )
+
+#define LOG_TRACE( category, ... ) LOG_AT( category, NLog::eTrace, __VA_ARGS__ )
+#define LOG_DEBUG( category, ... ) LOG_AT( category, NLog::eDebug, __VA_ARGS__ )
+#define LOG_INFO( category, ... ) LOG_AT( category, NLog::eInfo, __VA_ARGS__ )
+#define LOG_WARNING( category, ... ) LOG_AT( category, NLog::eWarning, __VA_ARGS__ )
+#define LOG_ERROR( category, ... ) LOG_AT( category, NLog::eError, __VA_ARGS__ )
+
+#endif
@@ -0,0 +1,284 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "ScanStats.h"
+
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace NScanStats
+{
+    namespace
+    {
+        // only the owning thread writes, so a relaxed load and store is enough and no locked add is needed
+        struct SThreadCounters
+        {
+            static constexpr int kMaxPhases = 32;
+
+            std::atomic< qint64 > fCounters[ eNumCounters ]{};
+            const char * fPhaseNames[ kMaxPhases ]{};
+            std::atomic< qint64 > fPhaseNSecs[ kMaxPhases ]{};
+            std::atomic< int > fNumPhases{ 0 };
+            std::atomic< int > fScan{ -1 }; // the last scan this thread counted in
+        };
+
+        std::mutex sMutex; // the thread list and the baseline, never taken while counting
+        std::vector< std::unique_ptr< SThreadCounters > > sThreads;
+        std::vector< SThreadCounters * > sFreeCounters; // owned by sThreads, their threads have exited
+        qint64 sRetiredCounters[ eNumCounters ]{}; // the totals of the exited threads
+        std::map< QString, qint64 > sRetiredPhases;
+        int sRetiredThreads{ 0 }; // exited threads that counted in the current scan
+        SStats sBaseline;
+        std::atomic< int > sScan{ 0 }; // bumped by every reset
+        std::chrono::steady_clock::time_point sResetTime = std::chrono::steady_clock::now();
+        QString sFileName;
+
+        qint64 nowNSecs()
+        {
+            return std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count();
+        }
+
+        // folds the exiting thread's totals into the retired ones so the sums never drop, then hands its counters
+        // to the next new thread
+        struct SThreadSlot
+        {
+            ~SThreadSlot()
+            {
+                if ( !fCounters )
+                    return;
+                std::lock_guard< std::mutex > lock( sMutex );
+                if ( fCounters->fScan.load( std::memory_order_relaxed ) == sScan.load( std::memory_order_relaxed ) )
+                    sRetiredThreads++;
+                for ( int ii = 0; ii < eNumCounters; ++ii )
+                    sRetiredCounters[ ii ] += fCounters->fCounters[ ii ].exchange( 0, std::memory_order_relaxed );
+                auto numPhases = fCounters->fNumPhases.exchange( 0, std::memory_order_relaxed );
+                for ( int ii = 0; ii < numPhases; ++ii )
+                {
+                    sRetiredPhases[ QString::fromUtf8( fCounters->fPhaseNames[ ii ] ) ] += fCounters->fPhaseNSecs[ ii ].exchange( 0, std::memory_order_relaxed );
+                    fCounters->fPhaseNames[ ii ] = nullptr;
+                }
+                fCounters->fScan.store( -1, std::memory_order_relaxed );
+                sFreeCounters.push_back( fCounters );
+            }
+
+            SThreadCounters * fCounters{ nullptr };
+        };
+
+        SThreadCounters * newThreadCounters()
+        {
+            std::lock_guard< std::mutex > lock( sMutex );
+            if ( !sFreeCounters.empty() )
+            {
+                auto retVal = sFreeCounters.back();
+                sFreeCounters.pop_back();
+                return retVal;
+            }
+            sThreads.push_back( std::make_unique< SThreadCounters >() );
+            return sThreads.back().get();
+        }
+
+        // also marks the thread as taking part in the current scan
+        SThreadCounters * threadCounters()
+        {
+            thread_local SThreadSlot sSlot;
+            if ( !sSlot.fCounters )
+                sSlot.fCounters = newThreadCounters();
+            auto counters = sSlot.fCounters;
+            auto scan = sScan.load( std::memory_order_relaxed );
+            if ( counters->fScan.load( std::memory_order_relaxed ) != scan )
+                counters->fScan.store( scan, std::memory_order_relaxed );
+            return counters;
+        }
+
+        void bump( std::atomic< qint64 > & counter, qint64 value )
+        {
+            counter.store( counter.load( std::memory_order_relaxed ) + value, std::memory_order_relaxed );
+        }
+
+        // the raw totals, sMutex must be held
+        SStats sum()
+        {
+            SStats retVal;
+            retVal.fThreads = sRetiredThreads;
+            for ( int ii = 0; ii < eNumCounters; ++ii )
+                retVal.fCounters[ ii ] = sRetiredCounters[ ii ];
+            auto phases = sRetiredPhases;
+            auto scan = sScan.load( std::memory_order_relaxed );
+            for ( auto && ii : sThreads )
+            {
+                if ( ii->fScan.load( std::memory_order_relaxed ) == scan )
+                    retVal.fThreads++;
+                for ( int jj = 0; jj < eNumCounters; ++jj )
+                    retVal.fCounters[ jj ] += ii->fCounters[ jj ].load( std::memory_order_relaxed );
+                auto numPhases = ii->fNumPhases.load( std::memory_order_acquire );
+                for ( int jj = 0; jj < numPhases; ++jj )
+                    phases[ QString::fromUtf8( ii->fPhaseNames[ jj ] ) ] += ii->fPhaseNSecs[ jj ].load( std::memory_order_relaxed );
+            }
+            retVal.fPhases.assign( phases.begin(), phases.end() );
+            return retVal;
+        }
+    }
+
+    QString counterName( ECounter counter )
+    {
+        switch ( counter )
+        {
+            case eDirsRead: return "dirsRead";
+            case eEntriesStated: return "entriesStated";
+            case eNFOBytes: return "nfoBytes";
+            case eM3UBytes: return "m3uBytes";
+            case eRegexEvals: return "regexEvals";
+            case eItemsCreated: return "itemsCreated";
+            default: return QString();
+        }
+    }
+
+    void add( ECounter counter, qint64 value /*= 1*/ )
+    {
+        bump( threadCounters()->fCounters[ counter ], value );
+    }
+
+    void addPhase( const char * name, qint64 nsecs )
+    {
+        auto counters = threadCounters();
+        auto numPhases = counters->fNumPhases.load( std::memory_order_relaxed );
+        for ( int ii = 0; ii < numPhases; ++ii )
+        {
+            if ( counters->fPhaseNames[ ii ] == name )
+            {
+                bump( counters->fPhaseNSecs[ ii ], nsecs );
+                return;
+            }
+        }
+        if ( numPhases == SThreadCounters::kMaxPhases )
+            return;
+
+        counters->fPhaseNames[ numPhases ] = name;
+        counters->fPhaseNSecs[ numPhases ].store( nsecs, std::memory_order_relaxed );
+        counters->fNumPhases.store( numPhases + 1, std::memory_order_release );
+    }
+
+    void reset()
+    {
+        std::lock_guard< std::mutex > lock( sMutex );
+        sBaseline = sum();
+        sScan++;
+        sRetiredThreads = 0;
+        sResetTime = std::chrono::steady_clock::now();
+    }
+
+    SStats collect()
+    {
+        std::lock_guard< std::mutex > lock( sMutex );
+        auto retVal = sum();
+        for ( int ii = 0; ii < eNumCounters; ++ii )
+            retVal.fCounters[ ii ] -= sBaseline.fCounters[ ii ];
+        for ( auto && ii : retVal.fPhases )
+        {
+            for ( auto && jj : sBaseline.fPhases )
+            {
+                if ( jj.first == ii.first )
+                    ii.second -= jj.second;
+            }
+        }
+        retVal.fWallNSecs = std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - sResetTime ).count();
+        return retVal;
+    }
+
+    QJsonObject SStats::toJson() const
+    {
+        QJsonObject counters;
+        for ( int ii = 0; ii < eNumCounters; ++ii )
+            counters[ counterName( static_cast< ECounter >( ii ) ) ] = fCounters[ ii ];
+
+        QJsonObject phases;
+        for ( auto && ii : fPhases )
+            phases[ ii.first ] = ii.second / 1000000.0;
+
+        QJsonObject retVal;
+        retVal[ "counters" ] = counters;
+        retVal[ "phasesMS" ] = phases;
+        retVal[ "threads" ] = fThreads;
+        retVal[ "wallMS" ] = fWallNSecs / 1000000.0;
+        return retVal;
+    }
+
+    bool write( const QString & fileName, const SStats & stats, QString & errorMsg )
+    {
+        QSaveFile file( fileName );
+        if ( !file.open( QSaveFile::WriteOnly ) )
+        {
+            errorMsg = QString( "Could not open '%1' for writing: %2" ).arg( fileName ).arg( file.errorString() );
+            return false;
+        }
+        file.write( QJsonDocument( stats.toJson() ).toJson() );
+        if ( !file.commit() )
+        {
+            errorMsg = QString( "Could not write '%1': %2" ).arg( fileName ).arg( file.errorString() );
+            return false;
+        }
+        return true;
+    }
+
+    void initFromArguments( QCoreApplication & appl )
+    {
+        auto args = appl.arguments();
+        for ( int ii = 1; ii < args.size(); ++ii )
+        {
+            if ( args[ ii ].startsWith( "--stats=" ) )
+                sFileName = args[ ii ].mid( 8 );
+            else if ( ( args[ ii ] == "--stats" ) && ( ( ii + 1 ) < args.size() ) )
+                sFileName = args[ ++ii ];
+        }
+        if ( sFileName.isEmpty() )
+            return;
+
+        QObject::connect( &appl, &QCoreApplication::aboutToQuit,
+            []()
+            {
+                QString errorMsg;
+                if ( !write( sFileName, collect(), errorMsg ) )
+                    std::cerr << qPrintable( errorMsg ) << std::endl;
+            } );
+    }
+
+    CPhase::CPhase( const char * name ) :
+        fName( name ),
+        fStart( nowNSecs() )
+    {
+    }
+
+    CPhase::~CPhase()
+    {
+        addPhase( fName, nowNSecs() - fStart );
+    }
+}
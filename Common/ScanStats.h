@@ -0,0 +1,93 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _SCANSTATS_H
+#define _SCANSTATS_H
+
+#include <QString>
+#include <QJsonObject>
+#include <vector>
+#include <utility>
+
+class QCoreApplication;
+
+// I/O and work counters for the directory scans
+//
+//     NScanStats::add( NScanStats::eDirsRead );
+//     SCAN_PHASE( "walk" );
+//
+// Every thread counts into its own slots, nothing is shared or locked while counting.  collect sums the
+// slots of all threads, reset only records a baseline so it never writes to another thread's slots
+namespace NScanStats
+{
+    enum ECounter
+    {
+        eDirsRead,
+        eEntriesStated,
+        eNFOBytes,
+        eM3UBytes,
+        eRegexEvals,
+        eItemsCreated,
+        eNumCounters
+    };
+    QString counterName( ECounter counter );
+
+    void add( ECounter counter, qint64 value = 1 );
+    // phase names must be string literals
+    void addPhase( const char * name, qint64 nsecs );
+
+    struct SStats
+    {
+        qint64 fCounters[ eNumCounters ]{};
+        std::vector< std::pair< QString, qint64 > > fPhases; // nsecs, summed over all threads
+        int fThreads{ 0 }; // that counted anything since the last reset
+        qint64 fWallNSecs{ 0 }; // since the last reset
+
+        QJsonObject toJson() const;
+    };
+
+    void reset();
+    SStats collect();
+
+    // "--stats out.json" on the command line writes the stats of the last scan when the application quits
+    void initFromArguments( QCoreApplication & appl );
+    bool write( const QString & fileName, const SStats & stats, QString & errorMsg );
+
+    class CPhase
+    {
+    public:
+        CPhase( const char * name );
+        ~CPhase();
+        CPhase( const CPhase & ) = delete;
+        CPhase & operator=( const CPhase & ) = delete;
+    private:
+        const char * fName;
+        qint64 fStart;
+    };
+}
+
+#define SCAN_PHASE_CONCAT_( lhs, rhs ) lhs##rhs
+#define SCAN_PHASE_CONCAT( lhs, rhs ) SCAN_PHASE_CONCAT_( lhs, rhs )
+#define SCAN_PHASE( name ) NScanStats::CPhase SCAN_PHASE_CONCAT( scanPhase_, __LINE__ )( name )
+
+#endif
@@ -0,0 +1,74 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "ScanStatsPanel.h"
+#include "ScanStats.h"
+
+#include <QHeaderView>
+#include <QLocale>
+#include <QTreeWidget>
+
+CScanStatsPanel::CScanStatsPanel( QWidget * parent /*= nullptr*/ ) :
+    QDockWidget( tr( "Scan Statistics" ), parent )
+{
+    setObjectName( "scanStatistics" );
+    fTree = new QTreeWidget( this );
+    fTree->setHeaderLabels( QStringList() << tr( "Counter" ) << tr( "Value" ) );
+    fTree->setRootIsDecorated( false );
+    fTree->setAlternatingRowColors( true );
+    fTree->header()->setSectionResizeMode( QHeaderView::ResizeToContents );
+    setWidget( fTree );
+}
+
+void CScanStatsPanel::startScan()
+{
+    NScanStats::reset();
+    fTree->clear();
+}
+
+void CScanStatsPanel::finishScan()
+{
+    setStats( NScanStats::collect() );
+}
+
+void CScanStatsPanel::setStats( const NScanStats::SStats & stats )
+{
+    QLocale locale;
+    fTree->clear();
+    auto addRow = [ this ]( const QString & name, const QString & value )
+    {
+        auto item = new QTreeWidgetItem( fTree, QStringList() << name << value );
+        item->setTextAlignment( 1, Qt::AlignRight | Qt::AlignVCenter );
+    };
+
+    addRow( tr( "Directories Read" ), locale.toString( stats.fCounters[ NScanStats::eDirsRead ] ) );
+    addRow( tr( "Entries Stat'ed" ), locale.toString( stats.fCounters[ NScanStats::eEntriesStated ] ) );
+    addRow( tr( "NFO Read" ), locale.formattedDataSize( stats.fCounters[ NScanStats::eNFOBytes ] ) );
+    addRow( tr( "M3U Read" ), locale.formattedDataSize( stats.fCounters[ NScanStats::eM3UBytes ] ) );
+    addRow( tr( "Regex Evaluations" ), locale.toString( stats.fCounters[ NScanStats::eRegexEvals ] ) );
+    addRow( tr( "Items Created" ), locale.toString( stats.fCounters[ NScanStats::eItemsCreated ] ) );
+    for ( auto && ii : stats.fPhases )
+        addRow( tr( "Phase '%1'" ).arg( ii.first ), tr( "%1ms" ).arg( locale.toString( ii.second / 1000000.0, 'f', 1 ) ) );
+    addRow( tr( "Threads" ), locale.toString( stats.fThreads ) );
+    addRow( tr( "Wall Time" ), tr( "%1ms" ).arg( locale.toString( stats.fWallNSecs / 1000000.0, 'f', 1 ) ) );
+}
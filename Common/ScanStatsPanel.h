@@ -0,0 +1,49 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _SCANSTATSPANEL_H
+#define _SCANSTATSPANEL_H
+
+#include <QDockWidget>
+
+namespace NScanStats { struct SStats; }
+class QTreeWidget;
+
+// Dockable view of the counters of the last scan, toggleViewAction brings it back once closed
+class CScanStatsPanel : public QDockWidget
+{
+    Q_OBJECT
+public:
+    CScanStatsPanel( QWidget * parent = nullptr );
+
+    // resets the counters, called when a scan starts
+    void startScan();
+    // shows the counters collected since startScan
+    void finishScan();
+
+    void setStats( const NScanStats::SStats & stats );
+private:
+    QTreeWidget * fTree{ nullptr };
+};
+
+#endif
@@ -0,0 +1,205 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "SyntheticLibrary.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <vector>
+
+namespace
+{
+    const char * kWords[] = { "Night", "Return", "Star", "Last", "City", "Dark", "Lost", "Road", "King", "Shadow", "River", "Moon", "Iron", "Silent", "Storm",
+                              "Empire", "Ghost", "Summer", "Secret", "Fire", "Winter", "Dream", "Blood", "Glass", "House", "Garden", "Edge", "Heart", "Ocean", "Stone" };
+}
+
+QString SSyntheticLibraryOptions::signature() const
+{
+    return QString( "version=2 entries=%1 depth=%2 folders=%3 id=%4 versions=%5 multi=%6 noise=%7 nfo=%8 m3u=%9 seed=%10" )
+        .arg( fEntries ).arg( fDepth ).arg( fFoldersPerLevel ).arg( fIDShare ).arg( fVersionShare ).arg( fMultiMovieShare ).arg( fNoiseShare )
+        .arg( fNFO ? 1 : 0 ).arg( fM3U ? 1 : 0 ).arg( fSeed );
+}
+
+CSyntheticLibrary::CSyntheticLibrary( const SSyntheticLibraryOptions & options ) :
+    fOptions( options ),
+    fRandom( options.fSeed )
+{
+}
+
+bool CSyntheticLibrary::isGenerated( const QString & rootDir, const SSyntheticLibraryOptions & options )
+{
+    QFile fi( QDir( rootDir ).absoluteFilePath( signatureFileName() ) );
+    if ( !fi.open( QFile::ReadOnly ) )
+        return false;
+    return QString::fromUtf8( fi.readAll() ).trimmed() == options.signature();
+}
+
+bool CSyntheticLibrary::chance( double share )
+{
+    return std::uniform_real_distribution< double >( 0.0, 1.0 )( fRandom ) < share;
+}
+
+QString CSyntheticLibrary::randomTitle()
+{
+    auto numWords = std::uniform_int_distribution< int >( 1, 4 )( fRandom );
+    QStringList words;
+    for ( int ii = 0; ii < numWords; ++ii )
+        words << kWords[ std::uniform_int_distribution< size_t >( 0, ( sizeof( kWords ) / sizeof( kWords[ 0 ] ) ) - 1 )( fRandom ) ];
+    return words.join( " " );
+}
+
+bool CSyntheticLibrary::makeDir( const QString & path, QString & errorMsg )
+{
+    if ( !QDir().mkpath( path ) )
+    {
+        errorMsg = QString( "Could not create directory '%1'" ).arg( path );
+        return false;
+    }
+    fNumEntries++;
+    return true;
+}
+
+bool CSyntheticLibrary::makeFile( const QString & path, const QByteArray & contents, QString & errorMsg )
+{
+    QFile fi( path );
+    if ( !fi.open( QFile::WriteOnly | QFile::Truncate ) )
+    {
+        errorMsg = QString( "Could not create file '%1'" ).arg( path );
+        return false;
+    }
+    fi.write( contents );
+    fNumEntries++;
+    return true;
+}
+
+bool CSyntheticLibrary::generate( const QString & rootDir, QString & errorMsg )
+{
+    fRandom.seed( fOptions.fSeed );
+    fNumEntries = 0;
+    fNumMovies = 0;
+    fUsedNames.clear();
+
+    auto root = QDir( rootDir );
+    if ( !QDir().mkpath( root.absolutePath() ) )
+    {
+        errorMsg = QString( "Could not create directory '%1'" ).arg( rootDir );
+        return false;
+    }
+
+    // the leaf categories, breadth first, the movies are then dealt to them round robin
+    QStringList categories = QStringList() << root.absolutePath();
+    for ( int depth = 0; depth < fOptions.fDepth; ++depth )
+    {
+        QStringList children;
+        for ( auto && ii : categories )
+        {
+            for ( int jj = 0; ( jj < fOptions.fFoldersPerLevel ) && !full(); ++jj )
+            {
+                auto child = QDir( ii ).absoluteFilePath( QString( "Category %1" ).arg( jj + 1, 2, 10, QChar( '0' ) ) );
+                if ( !makeDir( child, errorMsg ) )
+                    return false;
+                children << child;
+            }
+        }
+        if ( children.isEmpty() )
+            break;
+        categories = children;
+    }
+
+    std::vector< QStringList > playlists( categories.size() );
+    for ( int ii = 0; !full(); ii = ( ii + 1 ) % categories.size() )
+    {
+        if ( !addMovie( categories[ ii ], playlists[ ii ], errorMsg ) )
+            return false;
+    }
+
+    if ( fOptions.fM3U )
+    {
+        for ( int ii = 0; ii < categories.size(); ++ii )
+        {
+            if ( playlists[ ii ].isEmpty() )
+                continue;
+            auto contents = ( QStringList() << "#EXTM3U" << playlists[ ii ] ).join( "\n" ) + "\n";
+            if ( !makeFile( QDir( categories[ ii ] ).absoluteFilePath( QFileInfo( categories[ ii ] ).fileName() + ".m3u" ), contents.toUtf8(), errorMsg ) )
+                return false;
+        }
+    }
+
+    return makeFile( root.absoluteFilePath( signatureFileName() ), fOptions.signature().toUtf8(), errorMsg );
+}
+
+bool CSyntheticLibrary::addMovie( const QString & categoryDir, QStringList & playlist, QString & errorMsg )
+{
+    auto title = randomTitle();
+    auto year = std::uniform_int_distribution< int >( 1950, 2022 )( fRandom );
+    auto id = 10000 + fNumMovies++;
+    // a repeated name would land in an existing folder and match the wrong movie, so repeats become sequels
+    auto baseTitle = title;
+    for ( int sequel = 2; !fUsedNames.insert( QString( "%1 (%2)" ).arg( title ).arg( year ) ).second; ++sequel )
+        title = QString( "%1 %2" ).arg( baseTitle ).arg( sequel );
+    auto baseName = QString( "%1 (%2)" ).arg( title ).arg( year );
+    auto hasID = chance( fOptions.fIDShare );
+
+    auto dirName = hasID ? QString( "%1 [tmdbid=%2]" ).arg( baseName ).arg( id ) : baseName;
+    auto movieDir = QDir( categoryDir ).absoluteFilePath( dirName );
+    if ( !makeDir( movieDir, errorMsg ) || !makeFile( QDir( movieDir ).absoluteFilePath( baseName + ".mkv" ), QByteArray(), errorMsg ) )
+        return false;
+
+    if ( fOptions.fNFO && !full() )
+    {
+        auto nfo = QString( "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<movie>\n  <title>%1</title>\n  <tmdbid>%2</tmdbid>\n  <premiered>%3-01-01</premiered>\n</movie>\n" ).arg( title ).arg( id ).arg( year );
+        if ( !makeFile( QDir( movieDir ).absoluteFilePath( baseName + ".nfo" ), nfo.toUtf8(), errorMsg ) )
+            return false;
+    }
+
+    if ( chance( fOptions.fMultiMovieShare ) && !full() )
+    {
+        if ( !makeFile( QDir( movieDir ).absoluteFilePath( baseName + " - Part 2.mkv" ), QByteArray(), errorMsg ) )
+            return false;
+    }
+
+    if ( chance( fOptions.fNoiseShare ) && !full() )
+    {
+        auto extras = QDir( movieDir ).absoluteFilePath( chance( 0.5 ) ? "Extras" : "Featurettes" );
+        auto subs = QDir( movieDir ).absoluteFilePath( "Subs" );
+        if ( !makeDir( extras, errorMsg ) || !makeFile( QDir( extras ).absoluteFilePath( "Behind the Scenes.mkv" ), QByteArray(), errorMsg )
+             || !makeDir( subs, errorMsg ) || !makeFile( QDir( subs ).absoluteFilePath( "English.srt" ), QByteArray(), errorMsg ) )
+            return false;
+    }
+
+    if ( hasID && chance( fOptions.fVersionShare ) && !full() )
+    {
+        auto versionDir = QDir( categoryDir ).absoluteFilePath( QString( "%1 - 4K [tmdbid=%2]" ).arg( baseName ).arg( id ) );
+        auto fileName = chance( 0.5 ) ? QString( "%1 - 4K.mkv" ).arg( title ) : baseName + ".mkv";
+        if ( !makeDir( versionDir, errorMsg ) || !makeFile( QDir( versionDir ).absoluteFilePath( fileName ), QByteArray(), errorMsg ) )
+            return false;
+    }
+
+    // the playlists refer to the movies by stale, track numbered names
+    auto track = QString( "%1" ).arg( playlist.size() / 2 + 1, 2, 10, QChar( '0' ) );
+    playlist << QString( "#EXTINF:%1,%2 - %3" ).arg( 5400 + id % 1800 ).arg( track ).arg( title )
+             << QString( "%1/%2 - %3.mkv" ).arg( dirName ).arg( track ).arg( baseName );
+    return true;
+}
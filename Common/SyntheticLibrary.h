@@ -0,0 +1,79 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _SYNTHETICLIBRARY_H
+#define _SYNTHETICLIBRARY_H
+
+#include <QString>
+#include <QStringList>
+#include <random>
+#include <unordered_set>
+
+struct SSyntheticLibraryOptions
+{
+    int fEntries{ 10000 }; // files and directories, the generator stops once it has made this many
+    int fDepth{ 2 }; // category directories above the movie folders
+    int fFoldersPerLevel{ 10 };
+    double fIDShare{ 0.75 }; // movie folders named with [tmdbid=...]
+    double fVersionShare{ 0.1 }; // extra "Name (Year) - Version [tmdbid=...]" folders, half with a badly named movie
+    double fMultiMovieShare{ 0.05 }; // folders with a second movie in them
+    double fNoiseShare{ 0.2 }; // folders with Extras/Subs/Featurettes
+    bool fNFO{ true };
+    bool fM3U{ true }; // one playlist per category, with "NN - " names that need fixing
+    quint32 fSeed{ 1 };
+
+    // changes whenever the generated tree would
+    QString signature() const;
+};
+
+// Creates a reproducible, made up movie library for the benchmarks.  Movie files are empty, only names
+// and directory shapes matter to the scanners
+class CSyntheticLibrary
+{
+public:
+    CSyntheticLibrary( const SSyntheticLibraryOptions & options );
+
+    bool generate( const QString & rootDir, QString & errorMsg );
+
+    int numEntries() const { return fNumEntries; }
+    int numMovies() const { return fNumMovies; }
+
+    static QString signatureFileName() { return ".synthetic"; }
+    // true when rootDir was already generated with the same options
+    static bool isGenerated( const QString & rootDir, const SSyntheticLibraryOptions & options );
+private:
+    bool makeDir( const QString & path, QString & errorMsg );
+    bool makeFile( const QString & path, const QByteArray & contents, QString & errorMsg );
+    bool addMovie( const QString & categoryDir, QStringList & playlist, QString & errorMsg );
+    QString randomTitle();
+    bool chance( double share );
+    bool full() const { return fNumEntries >= fOptions.fEntries; }
+
+    SSyntheticLibraryOptions fOptions;
+    std::mt19937 fRandom;
+    int fNumEntries{ 0 };
+    int fNumMovies{ 0 };
+    std::unordered_set< QString > fUsedNames; // "Title (Year)", unique across the whole library
+};
+
+#endif
@@ -0,0 +1,237 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Trace.h"
+
+#include <QCoreApplication>
+#include <QSaveFile>
+#include <QThread>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace NTrace
+{
+    std::atomic< bool > gEnabled{ false };
+
+    namespace
+    {
+        struct SEvent
+        {
+            const char * fCategory;
+            const char * fName;
+            qint64 fStart;
+            qint64 fEnd;
+        };
+
+        // only the owning thread appends, fCount and fNext publish the events to the writer
+        struct SChunk
+        {
+            static constexpr int kSize = 4096;
+            SEvent fEvents[ kSize ];
+            std::atomic< int > fCount{ 0 };
+            std::atomic< SChunk * > fNext{ nullptr };
+        };
+
+        struct SThreadBuffer
+        {
+            ~SThreadBuffer()
+            {
+                for ( auto chunk = fHead.fNext.load(); chunk; )
+                {
+                    auto next = chunk->fNext.load();
+                    delete chunk;
+                    chunk = next;
+                }
+            }
+
+            int fID{ 0 };
+            QString fName;
+            QString fThreadName; // the owner's object name, empty for the anonymous workers
+            SChunk fHead;
+            SChunk * fTail{ &fHead };
+        };
+
+        std::mutex sMutex; // the buffer lists and the output file, never taken while recording
+        std::vector< std::unique_ptr< SThreadBuffer > > sBuffers;
+        std::vector< SThreadBuffer * > sFreeBuffers; // their threads have exited, events kept for write
+        std::chrono::steady_clock::time_point sEpoch;
+        QString sFileName;
+
+        // a buffer outlives its thread so write still sees the events.  The std::async workers come and go,
+        // so an exited thread's buffer is handed to the next new thread rather than a new one allocated each time
+        struct SThreadSlot
+        {
+            ~SThreadSlot()
+            {
+                if ( !fBuffer )
+                    return;
+                std::lock_guard< std::mutex > lock( sMutex );
+                sFreeBuffers.push_back( fBuffer );
+            }
+
+            SThreadBuffer * fBuffer{ nullptr };
+        };
+
+        SThreadBuffer * threadBuffer()
+        {
+            thread_local SThreadSlot sSlot;
+            if ( sSlot.fBuffer )
+                return sSlot.fBuffer;
+
+            auto thread = QThread::currentThread();
+            auto threadName = thread ? thread->objectName() : QString();
+
+            std::lock_guard< std::mutex > lock( sMutex );
+            // the previous owner has finished every scope, so the reused tid never overlaps itself.  Only a thread
+            // of the same name takes it over, so the trace never shows a worker's scopes under a named thread
+            for ( auto ii = sFreeBuffers.begin(); ii != sFreeBuffers.end(); ++ii )
+            {
+                if ( ( *ii )->fThreadName != threadName )
+                    continue;
+                sSlot.fBuffer = *ii;
+                sFreeBuffers.erase( ii );
+                return sSlot.fBuffer;
+            }
+
+            sBuffers.push_back( std::make_unique< SThreadBuffer >() );
+            auto buffer = sSlot.fBuffer = sBuffers.back().get();
+            buffer->fID = static_cast< int >( sBuffers.size() );
+            buffer->fThreadName = threadName;
+            if ( qApp && ( thread == qApp->thread() ) )
+                buffer->fName = "Main";
+            else if ( !threadName.isEmpty() )
+                buffer->fName = threadName;
+            else
+                buffer->fName = QString( "Worker %1" ).arg( buffer->fID );
+            return buffer;
+        }
+
+        QByteArray escaped( const QString & str )
+        {
+            auto retVal = str.toUtf8();
+            retVal.replace( "\\", "\\\\" ).replace( "\"", "\\\"" );
+            return retVal;
+        }
+    }
+
+    void enable()
+    {
+        if ( isEnabled() )
+            return;
+        sEpoch = std::chrono::steady_clock::now();
+        gEnabled.store( true );
+    }
+
+    qint64 now()
+    {
+        return std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - sEpoch ).count();
+    }
+
+    void record( const char * category, const char * name, qint64 start, qint64 end )
+    {
+        auto buffer = threadBuffer();
+        auto chunk = buffer->fTail;
+        auto count = chunk->fCount.load( std::memory_order_relaxed );
+        if ( count == SChunk::kSize )
+        {
+            auto next = new SChunk;
+            chunk->fNext.store( next, std::memory_order_release );
+            buffer->fTail = chunk = next;
+            count = 0;
+        }
+        chunk->fEvents[ count ] = { category, name, start, end };
+        chunk->fCount.store( count + 1, std::memory_order_release );
+    }
+
+    bool write( const QString & fileName, QString & errorMsg )
+    {
+        std::lock_guard< std::mutex > lock( sMutex );
+
+        QSaveFile file( fileName );
+        if ( !file.open( QSaveFile::WriteOnly ) )
+        {
+            errorMsg = QString( "Could not open '%1' for writing: %2" ).arg( fileName ).arg( file.errorString() );
+            return false;
+        }
+
+        QByteArray line;
+        bool first = true;
+        auto addEvent = [ &file, &first ]( const QByteArray & event )
+        {
+            file.write( first ? "\n" : ",\n" );
+            file.write( event );
+            first = false;
+        };
+
+        file.write( "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" );
+        for ( auto && ii : sBuffers )
+        {
+            addEvent( QString( "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%1,\"args\":{\"name\":\"%2\"}}" ).arg( ii->fID ).arg( QString::fromUtf8( escaped( ii->fName ) ) ).toUtf8() );
+            for ( auto chunk = &ii->fHead; chunk; chunk = chunk->fNext.load( std::memory_order_acquire ) )
+            {
+                auto count = chunk->fCount.load( std::memory_order_acquire );
+                for ( int jj = 0; jj < count; ++jj )
+                {
+                    auto && event = chunk->fEvents[ jj ];
+                    line = "{\"name\":\"" + escaped( event.fName ) + "\",\"cat\":\"" + escaped( event.fCategory ) + "\",\"ph\":\"X\",\"pid\":1,\"tid\":" + QByteArray::number( ii->fID )
+                        + ",\"ts\":" + QByteArray::number( event.fStart / 1000.0, 'f', 3 ) + ",\"dur\":" + QByteArray::number( ( event.fEnd - event.fStart ) / 1000.0, 'f', 3 ) + "}";
+                    addEvent( line );
+                }
+            }
+        }
+        file.write( "\n]}\n" );
+
+        if ( !file.commit() )
+        {
+            errorMsg = QString( "Could not write '%1': %2" ).arg( fileName ).arg( file.errorString() );
+            return false;
+        }
+        return true;
+    }
+
+    void initFromArguments( QCoreApplication & appl )
+    {
+        auto args = appl.arguments();
+        for ( int ii = 1; ii < args.size(); ++ii )
+        {
+            if ( args[ ii ].startsWith( "--trace=" ) )
+                sFileName = args[ ii ].mid( 8 );
+            else if ( ( args[ ii ] == "--trace" ) && ( ( ii + 1 ) < args.size() ) )
+                sFileName = args[ ++ii ];
+        }
+        if ( sFileName.isEmpty() )
+            return;
+
+        enable();
+        QObject::connect( &appl, &QCoreApplication::aboutToQuit,
+            []()
+            {
+                QString errorMsg;
+                if ( !write( sFileName, errorMsg ) )
+                    std::cerr << qPrintable( errorMsg ) << std::endl;
+            } );
+    }
+}
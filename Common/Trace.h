@@ -0,0 +1,79 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <QString>
+#include <atomic>
+
+class QCoreApplication;
+
+// Scoped timing of the hot paths, written in the Chrome trace format (chrome://tracing, ui.perfetto.dev)
+//
+//     TRACE_SCOPE( "scan", "CMovieIDIndex::scan" );
+//
+// Category and name must be string literals.  While tracing is off a scope costs a load and a branch,
+// once on each thread appends to its own buffer without taking a lock
+namespace NTrace
+{
+    extern std::atomic< bool > gEnabled;
+    inline bool isEnabled() { return gEnabled.load( std::memory_order_relaxed ); }
+
+    void enable();
+    qint64 now(); // nsecs since enable
+    void record( const char * category, const char * name, qint64 start, qint64 end );
+
+    // everything recorded so far, threads still running are included up to their last finished scope
+    bool write( const QString & fileName, QString & errorMsg );
+
+    // "--trace out.json" on the command line enables tracing and writes the file when the application quits
+    void initFromArguments( QCoreApplication & appl );
+
+    class CScope
+    {
+    public:
+        CScope( const char * category, const char * name ) :
+            fCategory( category ),
+            fName( name ),
+            fStart( isEnabled() ? now() : -1 )
+        {
+        }
+        ~CScope()
+        {
+            if ( fStart >= 0 )
+                record( fCategory, fName, fStart, now() );
+        }
+        CScope( const CScope & ) = delete;
+        CScope & operator=( const CScope & ) = delete;
+    private:
+        const char * fCategory;
+        const char * fName;
+        qint64 fStart;
+    };
+}
+
+#define TRACE_CONCAT_( lhs, rhs ) lhs##rhs
+#define TRACE_CONCAT( lhs, rhs ) TRACE_CONCAT_( lhs, rhs )
+#define TRACE_SCOPE( category, name ) NTrace::CScope TRACE_CONCAT( traceScope_, __LINE__ )( category, name )
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef LIBRARYMODEL_H
+#define LIBRARYMODEL_H
+
+#include <QSqlTableModel>
+#include <QSqlRecord>
+#include <QSortFilterProxyModel>
+#include <QRegularExpression>
+
+char* dbConnectionName();
+QString regEx();
+
+// The movie rows of the MediaItems table in an Emby library.db, only the name related columns are selected
+class CSqlTableModel : public QSqlTableModel
+{
+public:
+	CSqlTableModel(const QString & fileName, QObject* parent);
+
+	QSqlRecord record(int rowNumber) const;
+	QSqlRecord record() const;
+
+	QString selectStatement() const override;
+
+	// sets the names from the "NN - name" file name, returns false when the file name is not numbered
+	bool autoFix(int row);
+};
+
+// Only the rows whose file name needs fixing
+class CFilterModel : public QSortFilterProxyModel 
+{
+public:
+	CFilterModel(CSqlTableModel* parent);
+
+	bool filterAcceptsRow(int source_row, const QModelIndex& /*source_parent*/) const;
+private:
+	CSqlTableModel* fSQLModel{ nullptr };
+	QRegularExpression fRegEx;
+};
+
+#endif 
@@ -22,6 +22,7 @@
 
 set(qtproject_SRCS
     MainWindow.cpp
+    LibraryModel.cpp
 )
 
 set(qtproject_H
@@ -29,6 +30,7 @@ set(qtproject_H
 )
 
 set(project_H
+    LibraryModel.h
 )
 
 set(qtproject_UIS
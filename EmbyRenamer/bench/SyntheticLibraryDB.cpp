@@ -0,0 +1,172 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "SyntheticLibraryDB.h"
+
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QUuid>
+#include <QVariant>
+
+namespace
+{
+    const char * kWords[] = { "night", "return", "star", "last", "city", "dark", "lost", "road", "king", "shadow", "river", "moon", "iron", "silent", "storm",
+                              "empire", "ghost", "summer", "secret", "fire", "winter", "dream", "blood", "glass", "house", "garden", "edge", "heart", "ocean", "stone" };
+    const char * kExtensions[] = { "mkv", "mp4", "avi", "m4v" };
+    const char * kConnectionName = "synthetic_library_db";
+
+    QString capitalized( const QString & words )
+    {
+        auto retVal = words;
+        for ( int ii = 0; ii < retVal.length(); ++ii )
+        {
+            if ( ( ii == 0 ) || ( retVal[ ii - 1 ] == ' ' ) )
+                retVal[ ii ] = retVal[ ii ].toUpper();
+        }
+        return retVal;
+    }
+}
+
+CSyntheticLibraryDB::CSyntheticLibraryDB( const SSyntheticLibraryDBOptions & options ) :
+    fOptions( options ),
+    fRandom( options.fSeed )
+{
+}
+
+bool CSyntheticLibraryDB::chance( double share )
+{
+    return std::uniform_real_distribution< double >( 0.0, 1.0 )( fRandom ) < share;
+}
+
+QString CSyntheticLibraryDB::randomWords( int min, int max )
+{
+    auto numWords = std::uniform_int_distribution< int >( min, max )( fRandom );
+    QStringList words;
+    for ( int ii = 0; ii < numWords; ++ii )
+        words << kWords[ std::uniform_int_distribution< size_t >( 0, ( sizeof( kWords ) / sizeof( kWords[ 0 ] ) ) - 1 )( fRandom ) ];
+    return words.join( " " );
+}
+
+bool CSyntheticLibraryDB::generate( const QString & fileName, QString & errorMsg )
+{
+    fRandom.seed( fOptions.fSeed );
+    fNumNumbered = 0;
+
+    for ( auto && ii : { QString(), QString( "-wal" ), QString( "-shm" ), QString( "-journal" ) } )
+    {
+        if ( QFile::exists( fileName + ii ) && !QFile::remove( fileName + ii ) )
+        {
+            errorMsg = QString( "Could not remove '%1'" ).arg( fileName + ii );
+            return false;
+        }
+    }
+
+    bool aOK = true;
+    {
+        auto db = QSqlDatabase::addDatabase( "QSQLITE", kConnectionName );
+        db.setDatabaseName( fileName );
+        aOK = db.open();
+        if ( !aOK )
+            errorMsg = QString( "Could not create '%1': %2" ).arg( fileName ).arg( db.lastError().text() );
+
+        // the columns renamed by EmbyRenamer plus the wide ones every Emby row carries
+        QSqlQuery query( db );
+        aOK = aOK && query.exec( "PRAGMA synchronous=OFF" );
+        aOK = aOK && query.exec( "CREATE TABLE MediaItems ( Id INTEGER PRIMARY KEY, type INT NOT NULL, guid GUID NOT NULL, ParentId INT, Path TEXT, Filename TEXT,"
+                                 " Name TEXT, SortName TEXT, ForcedSortName TEXT, OriginalTitle TEXT, LockedFields TEXT, IsFolder BIT, IsMovie BIT, MediaType TEXT,"
+                                 " Overview TEXT, Tagline TEXT, Genres TEXT, Studios TEXT, Tags TEXT, ProviderIds TEXT, Images TEXT, ProductionYear INT,"
+                                 " PremiereDate DATETIME, DateCreated DATETIME, DateModified DATETIME, RunTimeTicks BIGINT, Size BIGINT, Container TEXT,"
+                                 " CommunityRating FLOAT, OfficialRating TEXT, PresentationUniqueKey TEXT )" );
+        aOK = aOK && query.exec( "CREATE INDEX idx_PathMediaItems ON MediaItems ( Path )" );
+        aOK = aOK && db.transaction();
+        aOK = aOK && query.prepare( "INSERT INTO MediaItems ( Id, type, guid, ParentId, Path, Filename, Name, SortName, ForcedSortName, OriginalTitle, LockedFields,"
+                                    " IsFolder, IsMovie, MediaType, Overview, Tagline, Genres, Studios, Tags, ProviderIds, Images, ProductionYear, PremiereDate,"
+                                    " DateCreated, DateModified, RunTimeTicks, Size, Container, CommunityRating, OfficialRating, PresentationUniqueKey )"
+                                    " VALUES ( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ? )" );
+
+        for ( int ii = 0; aOK && ( ii < fOptions.fRows ); ++ii )
+        {
+            auto isMovie = chance( fOptions.fMovieShare );
+            auto isFolder = chance( fOptions.fFolderShare );
+            auto title = capitalized( randomWords( 1, 5 ) );
+            auto year = std::uniform_int_distribution< int >( 1950, 2022 )( fRandom );
+            auto ext = kExtensions[ std::uniform_int_distribution< int >( 0, 3 )( fRandom ) ];
+            auto root = isMovie ? QString( "/volume2/video/Movies" ) : chance( 0.7 ) ? QString( "/volume2/video/TV" ) : QString( "/volume1/music" );
+            auto folder = QString( "%1/%2 (%3)" ).arg( root ).arg( title ).arg( year );
+
+            QString movieFile;
+            if ( !isFolder )
+            {
+                if ( isMovie && chance( fOptions.fNumberedShare ) )
+                {
+                    movieFile = QString( "%1 - %2.%3" ).arg( std::uniform_int_distribution< int >( 1, 40 )( fRandom ), 2, 10, QChar( '0' ) ).arg( title ).arg( ext );
+                    fNumNumbered++;
+                }
+                else
+                    movieFile = QString( "%1 (%2).%3" ).arg( title ).arg( year ).arg( ext );
+            }
+            auto path = isFolder ? folder : folder + "/" + movieFile;
+            auto created = QString( "%1-%2-%3 12:00:00" ).arg( std::uniform_int_distribution< int >( 2010, 2022 )( fRandom ) ).arg( 1 + ii % 12, 2, 10, QChar( '0' ) ).arg( 1 + ii % 28, 2, 10, QChar( '0' ) );
+
+            query.addBindValue( ii + 1 );
+            query.addBindValue( isFolder ? 1 : 5 );
+            query.addBindValue( QUuid::createUuid().toRfc4122() );
+            query.addBindValue( ii / 50 + 1 );
+            query.addBindValue( path );
+            query.addBindValue( isFolder ? QVariant( QVariant::String ) : QVariant( movieFile ) );
+            query.addBindValue( title );
+            query.addBindValue( title.toLower() );
+            query.addBindValue( QVariant( QVariant::String ) );
+            query.addBindValue( title );
+            query.addBindValue( QVariant( QVariant::String ) );
+            query.addBindValue( isFolder ? 1 : 0 );
+            query.addBindValue( isMovie ? 1 : 0 );
+            query.addBindValue( isFolder ? QString() : QString( "Video" ) );
+            query.addBindValue( capitalized( randomWords( 40, 110 ) ) + "." );
+            query.addBindValue( capitalized( randomWords( 3, 10 ) ) );
+            query.addBindValue( "Drama|Action|Thriller" );
+            query.addBindValue( capitalized( randomWords( 1, 3 ) ) + " Pictures" );
+            query.addBindValue( QString() );
+            query.addBindValue( QString( "Tmdb=%1|Imdb=tt%2" ).arg( 10000 + ii ).arg( 1000000 + ii ) );
+            query.addBindValue( QString( "%1/poster.jpg*637245312000000000*Primary*1000*1500*ZNDR,%1/fanart.jpg*637245312000000000*Backdrop*1920*1080*WB7L" ).arg( folder ) );
+            query.addBindValue( year );
+            query.addBindValue( QString( "%1-01-01 00:00:00" ).arg( year ) );
+            query.addBindValue( created );
+            query.addBindValue( created );
+            query.addBindValue( isFolder ? QVariant( QVariant::LongLong ) : QVariant( qint64( 54000000000 ) + ii ) );
+            query.addBindValue( isFolder ? QVariant( QVariant::LongLong ) : QVariant( qint64( 4000000000 ) + ii ) );
+            query.addBindValue( isFolder ? QString() : QString( ext ) );
+            query.addBindValue( 5.0 + ( ii % 50 ) / 10.0 );
+            query.addBindValue( "PG-13" );
+            query.addBindValue( QString( "%1" ).arg( 10000 + ii ) );
+            aOK = query.exec();
+        }
+        aOK = aOK && db.commit();
+        if ( !aOK && errorMsg.isEmpty() )
+            errorMsg = QString( "Could not write '%1': %2" ).arg( fileName ).arg( query.lastError().text() );
+        db.close();
+    }
+    QSqlDatabase::removeDatabase( kConnectionName );
+    return aOK;
+}
@@ -0,0 +1,57 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _SYNTHETICLIBRARYDB_H
+#define _SYNTHETICLIBRARYDB_H
+
+#include <QString>
+#include <random>
+
+struct SSyntheticLibraryDBOptions
+{
+    int fRows{ 100000 };
+    double fMovieShare{ 0.6 }; // rows under /volume2/video/Movies, the rest are TV and music
+    double fFolderShare{ 0.1 }; // IsFolder rows
+    double fNumberedShare{ 0.25 }; // movie files named "NN - name.ext", the ones the auto fix changes
+    quint32 fSeed{ 1 };
+};
+
+// Writes an Emby library.db with a MediaItems table of made up rows.  The columns the renamer does not
+// select are filled to realistic widths, so the rows cost what real ones do to read and write
+class CSyntheticLibraryDB
+{
+public:
+    CSyntheticLibraryDB( const SSyntheticLibraryDBOptions & options );
+
+    bool generate( const QString & fileName, QString & errorMsg );
+
+    int numNumbered() const { return fNumNumbered; }
+private:
+    QString randomWords( int min, int max );
+    bool chance( double share );
+
+    SSyntheticLibraryDBOptions fOptions;
+    std::mt19937 fRandom;
+    int fNumNumbered{ 0 };
+};
+
+#endif
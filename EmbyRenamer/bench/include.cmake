@@ -0,0 +1,24 @@
+set(qtproject_SRCS
+    main.cpp
+    SyntheticLibraryDB.cpp
+)
+
+set(qtproject_H
+)
+
+set(project_H
+    SyntheticLibraryDB.h
+)
+
+set(qtproject_UIS
+)
+
+
+set(qtproject_QRC
+)
+
+set( project_pub_DEPS
+        SABUtils
+        MediaToolsCommon
+        EmbyRenamerMainWindow
+)
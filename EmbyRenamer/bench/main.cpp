@@ -0,0 +1,201 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "SyntheticLibraryDB.h"
+#include "MainWindow/LibraryModel.h"
+#include "Common/Benchmark.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSqlDatabase>
+#include <QTemporaryDir>
+
+#include <iostream>
+#include <limits>
+#include <memory>
+
+namespace
+{
+    struct SStage
+    {
+        const char * fName;
+        qint64 fBest{ std::numeric_limits< qint64 >::max() };
+        qint64 fTotal{ 0 };
+        int fRows{ 0 };
+
+        void add( const QElapsedTimer & timer, int rows )
+        {
+            auto nsecs = std::max< qint64 >( 1, timer.nsecsElapsed() );
+            fBest = std::min( fBest, nsecs );
+            fTotal += nsecs;
+            fRows = rows;
+        }
+    };
+
+    bool copyDB( const QString & from, const QString & to, QString & errorMsg )
+    {
+        QSqlDatabase::database( dbConnectionName(), false ).close();
+        if ( QFile::exists( to ) && !QFile::remove( to ) )
+        {
+            errorMsg = QString( "Could not remove '%1'" ).arg( to );
+            return false;
+        }
+        if ( !QFile::copy( from, to ) )
+        {
+            errorMsg = QString( "Could not copy '%1' to '%2'" ).arg( from ).arg( to );
+            return false;
+        }
+        return true;
+    }
+}
+
+int main( int argc, char ** argv )
+{
+    CBenchmark::setHeadless();
+    QApplication appl( argc, argv );
+    appl.setApplicationName( "EmbyRenamerBench" );
+    appl.setOrganizationName( "OnShore Consulting Services" );
+    appl.setOrganizationDomain( "www.towel42.com" );
+
+    QCommandLineParser cmdLine;
+    cmdLine.setApplicationDescription( "Times loading, filtering, fixing and committing synthetic Emby library.db files" );
+    cmdLine.addHelpOption();
+    QCommandLineOption rowsOption( QStringList() << "r" << "rows", "Comma separated number of MediaItems rows", "counts", "100000" );
+    QCommandLineOption iterationsOption( QStringList() << "i" << "iterations", "Number of times each library is processed", "count", "3" );
+    QCommandLineOption numberedOption( "numbered-share", "Share of movie files named \"NN - name\"", "share", "0.25" );
+    QCommandLineOption seedOption( "seed", "Seed for the generator", "seed", "1" );
+    QCommandLineOption generateOption( "generate", "Only write a library of the first --rows size to the file", "file" );
+    cmdLine.addOption( rowsOption );
+    cmdLine.addOption( iterationsOption );
+    cmdLine.addOption( numberedOption );
+    cmdLine.addOption( seedOption );
+    cmdLine.addOption( generateOption );
+    cmdLine.process( appl );
+
+    std::vector< int > rowCounts;
+    for ( auto && ii : cmdLine.value( rowsOption ).split( ",", Qt::SkipEmptyParts ) )
+    {
+        if ( ii.trimmed().toInt() > 0 )
+            rowCounts.push_back( ii.trimmed().toInt() );
+    }
+    if ( rowCounts.empty() )
+        rowCounts.push_back( 100000 );
+    auto iterations = std::max( 1, cmdLine.value( iterationsOption ).toInt() );
+
+    SSyntheticLibraryDBOptions options;
+    options.fNumberedShare = cmdLine.value( numberedOption ).toDouble();
+    options.fSeed = cmdLine.value( seedOption ).toUInt();
+
+    QString errorMsg;
+    if ( cmdLine.isSet( generateOption ) )
+    {
+        options.fRows = rowCounts.front();
+        CSyntheticLibraryDB generator( options );
+        if ( !generator.generate( cmdLine.value( generateOption ), errorMsg ) )
+        {
+            std::cerr << qPrintable( errorMsg ) << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << options.fRows << " rows, " << generator.numNumbered() << " to be fixed" << std::endl;
+        return 0;
+    }
+
+    if ( !QSqlDatabase::isDriverAvailable( "QSQLITE" ) )
+    {
+        std::cerr << "The QSQLITE driver is not available" << std::endl;
+        return 1;
+    }
+    QSqlDatabase::addDatabase( "QSQLITE", dbConnectionName() );
+
+    QTemporaryDir tmpDir;
+    if ( !tmpDir.isValid() )
+    {
+        std::cerr << "Could not create temporary directory" << std::endl;
+        return 1;
+    }
+
+    for ( auto && numRows : rowCounts )
+    {
+        options.fRows = numRows;
+        auto original = tmpDir.filePath( QString( "library_%1.db" ).arg( numRows ) );
+        auto work = tmpDir.filePath( "library.db" );
+
+        QElapsedTimer timer;
+        timer.start();
+        CSyntheticLibraryDB generator( options );
+        if ( !generator.generate( original, errorMsg ) )
+        {
+            std::cerr << qPrintable( errorMsg ) << std::endl;
+            return 1;
+        }
+        std::cout << "Generated " << numRows << " rows (" << generator.numNumbered() << " to be fixed) in " << timer.elapsed() << "ms" << std::endl;
+
+        // the same steps as the window, each on a fresh copy since the commit changes it
+        SStage stages[] = { { "load" }, { "filter" }, { "fix" }, { "commit" } };
+        for ( int ii = 0; ii < iterations; ++ii )
+        {
+            if ( !copyDB( original, work, errorMsg ) )
+            {
+                std::cerr << qPrintable( errorMsg ) << std::endl;
+                return 1;
+            }
+
+            timer.restart();
+            auto model = std::make_unique< CSqlTableModel >( work, nullptr );
+            model->select();
+            while ( model->canFetchMore() )
+                model->fetchMore();
+            stages[ 0 ].add( timer, model->rowCount() );
+
+            timer.restart();
+            auto filterModel = new CFilterModel( model.get() );
+            auto numFiltered = filterModel->rowCount();
+            stages[ 1 ].add( timer, model->rowCount() );
+
+            timer.restart();
+            for ( int jj = 0; jj < numFiltered; ++jj )
+                model->autoFix( filterModel->mapToSource( filterModel->index( jj, 3 ) ).row() );
+            stages[ 2 ].add( timer, numFiltered );
+
+            timer.restart();
+            if ( !model->submitAll() )
+            {
+                std::cerr << "Commit failed" << std::endl;
+                return 1;
+            }
+            stages[ 3 ].add( timer, numFiltered );
+        }
+
+        for ( auto && ii : stages )
+        {
+            std::cout << numRows << " rows, " << ii.fName << " (" << ii.fRows << " rows): "
+                << ( ii.fBest / 1000000.0 ) << "ms best, "
+                << ( ii.fTotal / iterations / 1000000.0 ) << "ms average, "
+                << static_cast< qint64 >( ii.fRows * 1e9 / ii.fBest ) << " rows/s" << std::endl;
+        }
+    }
+    QSqlDatabase::database( dbConnectionName(), false ).close();
+    return 0;
+}
@@ -1,4 +1,6 @@
 #include "MainWindow/MainWindow.h"
+#include "Common/Trace.h"
+#include "Common/Log.h"
 
 #include <QApplication>
 #include <QMessageBox>
@@ -13,6 +15,8 @@ int main( int argc, char ** argv )
     QCoreApplication::setApplicationName( "Emby Renamer" );
     QCoreApplication::setApplicationVersion( "1.0.0" );
     QCoreApplication::setOrganizationDomain( "www.towel42.com" );
+    NTrace::initFromArguments( appl );
+    NLog::initFromArguments( appl );
     appl.setWindowIcon( QPixmap( ":/resources/finddupe.png" ) );
 
     QString appDir = appl.applicationDirPath();
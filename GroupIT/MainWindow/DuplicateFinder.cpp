@@ -0,0 +1,247 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "DuplicateFinder.h"
+#include "Common/Trace.h"
+#include "Common/DirWalker.h"
+
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <future>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+
+CDuplicateFinder::CDuplicateFinder( const QStringList & rootDirs, const QStringList & nameFilters, QObject * parent ) :
+    QThread( parent ),
+    fRootDirs( rootDirs ),
+    fNameFilters( nameFilters )
+{
+}
+
+void CDuplicateFinder::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    TCandidates files;
+    fStage = eWalking;
+    for ( auto && ii : fRootDirs )
+        walk( ii, files );
+    fStatistics.fFiles = static_cast< int >( files.size() );
+    for ( auto && ii : files )
+        fStatistics.fBytesTotal += ii.fSize;
+
+    auto candidates = sameSize( uniquePaths( sameSize( std::move( files ) ) ) );
+    fStatistics.fSizeCandidates = static_cast< int >( candidates.size() );
+
+    fStage = eSampling;
+    hash( candidates, false );
+    candidates = sameHash( std::move( candidates ) );
+    fStatistics.fSampleCandidates = static_cast< int >( candidates.size() );
+
+    fStage = eHashing;
+    hash( candidates, true );
+    candidates = sameHash( std::move( candidates ) );
+
+    // sorted by size then hash, so every group is a contiguous run
+    for ( size_t ii = 0; ii < candidates.size(); )
+    {
+        SDuplicateGroup group;
+        group.fSize = candidates[ ii ].fSize;
+        group.fHash = candidates[ ii ].fHash;
+        for ( ; ( ii < candidates.size() ) && ( candidates[ ii ].fSize == group.fSize ) && ( candidates[ ii ].fHash == group.fHash ); ++ii )
+            group.fPaths << candidates[ ii ].fPath;
+        fDuplicates.push_back( group );
+    }
+
+    fStatistics.fBytesRead = fBytesRead;
+    fStatistics.fMS = timer.elapsed();
+    fStage = eDone;
+}
+
+void CDuplicateFinder::walk( const QString & rootDir, TCandidates & files )
+{
+    TRACE_SCOPE( "scan", "CDuplicateFinder::walk" );
+    // the listing gives the type of every entry, only the files that pass the filters are stat'ed for their size
+    NDirWalker::CNameFilter nameFilter( fNameFilters );
+    auto isCandidate = [ &nameFilter ]( const NDirWalker::SEntry & entry ) { return entry.fIsFile && ( nameFilter.isEmpty() || nameFilter.match( entry.fName ) ); };
+    std::vector< QString > pending{ rootDir };
+    std::vector< NDirWalker::SEntry > entries;
+    while ( !pending.empty() )
+    {
+        if ( isInterruptionRequested() )
+            return;
+
+        auto dirPath = std::move( pending.back() );
+        pending.pop_back();
+        NDirWalker::readDir( dirPath, entries, isCandidate );
+        for ( auto && ii : entries )
+        {
+            if ( ii.fIsDir )
+            {
+                pending.push_back( NDirWalker::filePath( dirPath, ii ) );
+                continue;
+            }
+            if ( !isCandidate( ii ) || ( ii.fSize <= 0 ) )
+                continue;
+
+            SCandidate curr;
+            curr.fPath = NDirWalker::filePath( dirPath, ii );
+            curr.fSize = ii.fSize;
+            files.push_back( curr );
+        }
+        fProgress = static_cast< int >( files.size() );
+    }
+}
+
+CDuplicateFinder::TCandidates CDuplicateFinder::sameSize( TCandidates && files ) const
+{
+    std::unordered_map< qint64, int > counts;
+    for ( auto && ii : files )
+        counts[ ii.fSize ]++;
+
+    TCandidates retVal;
+    for ( auto && ii : files )
+    {
+        if ( counts[ ii.fSize ] > 1 )
+            retVal.push_back( std::move( ii ) );
+    }
+    return retVal;
+}
+
+CDuplicateFinder::TCandidates CDuplicateFinder::uniquePaths( TCandidates && files ) const
+{
+    // the same file reached through a link, or through two roots, is not a duplicate of itself.  Only the
+    // files sharing a size get here, so resolving them is cheap next to hashing them
+    std::unordered_set< QString > seen;
+    TCandidates retVal;
+    for ( auto && ii : files )
+    {
+        auto canonical = QFileInfo( ii.fPath ).canonicalFilePath();
+        if ( canonical.isEmpty() )
+            canonical = ii.fPath;
+        if ( seen.insert( canonical ).second )
+            retVal.push_back( std::move( ii ) );
+    }
+    return retVal;
+}
+
+CDuplicateFinder::TCandidates CDuplicateFinder::sameHash( TCandidates && files ) const
+{
+    // a file that could not be read has no hash and is dropped here
+    std::map< std::pair< qint64, QByteArray >, int > counts;
+    for ( auto && ii : files )
+    {
+        if ( !ii.fHash.isEmpty() )
+            counts[ std::make_pair( ii.fSize, ii.fHash ) ]++;
+    }
+
+    TCandidates retVal;
+    for ( auto && ii : files )
+    {
+        if ( !ii.fHash.isEmpty() && ( counts[ std::make_pair( ii.fSize, ii.fHash ) ] > 1 ) )
+            retVal.push_back( std::move( ii ) );
+    }
+    std::sort( retVal.begin(), retVal.end(), []( const SCandidate & lhs, const SCandidate & rhs ) { return std::make_pair( lhs.fSize, lhs.fHash ) < std::make_pair( rhs.fSize, rhs.fHash ); } );
+    return retVal;
+}
+
+void CDuplicateFinder::hash( TCandidates & files, bool fullHash )
+{
+    TRACE_SCOPE( "hash", "CDuplicateFinder::hash" );
+    fProgress = 0;
+    fProgressTotal = static_cast< int >( files.size() );
+
+    // each task takes the next file, the files vary too much in size to split up front
+    std::atomic< size_t > next{ 0 };
+    std::atomic< int > unreadable{ 0 };
+    auto numTasks = std::max( 1, std::min( QThread::idealThreadCount(), static_cast< int >( files.size() ) ) );
+    std::vector< std::future< void > > tasks;
+    for ( int ii = 0; ii < numTasks; ++ii )
+    {
+        tasks.push_back( std::async( std::launch::async, [ this, &files, &next, &unreadable, fullHash ]()
+            {
+                for ( auto jj = next++; ( jj < files.size() ) && !isInterruptionRequested(); jj = next++ )
+                {
+                    auto && curr = files[ jj ];
+                    // small files are read whole by the sampling pass, no point reading them twice
+                    if ( !curr.fFullHash && ( fullHash || ( curr.fSize <= 3 * kSampleSize ) ) )
+                    {
+                        curr.fHash = this->fullHash( curr.fPath );
+                        curr.fFullHash = true;
+                    }
+                    else if ( !fullHash )
+                        curr.fHash = sampleHash( curr.fPath, curr.fSize );
+                    if ( curr.fHash.isEmpty() )
+                        unreadable++;
+                    fProgress++;
+                }
+            } ) );
+    }
+
+    for ( auto && ii : tasks )
+        ii.get();
+    fStatistics.fUnreadable += unreadable;
+}
+
+QByteArray CDuplicateFinder::sampleHash( const QString & path, qint64 size )
+{
+    QFile fi( path );
+    if ( !fi.open( QFile::ReadOnly ) )
+        return QByteArray();
+
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    for ( auto && offset : { qint64( 0 ), ( size - kSampleSize ) / 2, size - kSampleSize } )
+    {
+        if ( !fi.seek( offset ) )
+            return QByteArray();
+        auto data = fi.read( kSampleSize );
+        fBytesRead += data.size();
+        hash.addData( data );
+    }
+    return hash.result();
+}
+
+QByteArray CDuplicateFinder::fullHash( const QString & path )
+{
+    QFile fi( path );
+    if ( !fi.open( QFile::ReadOnly ) )
+        return QByteArray();
+
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    while ( !fi.atEnd() )
+    {
+        if ( isInterruptionRequested() )
+            return QByteArray();
+        auto data = fi.read( 1024 * 1024 );
+        if ( data.isEmpty() )
+            return QByteArray();
+        fBytesRead += data.size();
+        hash.addData( data );
+    }
+    return hash.result();
+}
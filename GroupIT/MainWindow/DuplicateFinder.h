@@ -0,0 +1,107 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _DUPLICATEFINDER_H
+#define _DUPLICATEFINDER_H
+
+#include <QThread>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <atomic>
+#include <vector>
+
+struct SDuplicateGroup
+{
+    qint64 fSize{ 0 };
+    QByteArray fHash; // SHA1 of the whole file
+    QStringList fPaths;
+};
+
+struct SDuplicateStatistics
+{
+    int fFiles{ 0 };
+    int fSizeCandidates{ 0 }; // share their size with another file
+    int fSampleCandidates{ 0 }; // also share their sampled hash
+    int fUnreadable{ 0 };
+    qint64 fBytesTotal{ 0 }; // what hashing every file would have read
+    qint64 fBytesRead{ 0 };
+    qint64 fMS{ 0 };
+};
+
+// Finds media files with identical contents regardless of name.  Files are bucketed by size, files
+// sharing a size are hashed on a few sampled chunks, and only those still matching are hashed in full.
+// The hashing runs in parallel, the GUI polls stage() and progress() while it runs
+class CDuplicateFinder : public QThread
+{
+public:
+    enum EStage
+    {
+        eWalking,
+        eSampling,
+        eHashing,
+        eDone
+    };
+
+    CDuplicateFinder( const QStringList & rootDirs, const QStringList & nameFilters, QObject * parent );
+
+    void run() override;
+
+    EStage stage() const { return fStage; }
+    int progress() const { return fProgress; }
+    int progressTotal() const { return fProgressTotal; }
+
+    const std::vector< SDuplicateGroup > & duplicates() const { return fDuplicates; }
+    const SDuplicateStatistics & statistics() const { return fStatistics; }
+
+    static const qint64 kSampleSize = 64 * 1024;
+private:
+    struct SCandidate
+    {
+        QString fPath;
+        qint64 fSize{ 0 };
+        QByteArray fHash;
+        bool fFullHash{ false };
+    };
+    using TCandidates = std::vector< SCandidate >;
+
+    void walk( const QString & rootDir, TCandidates & files );
+    TCandidates sameSize( TCandidates && files ) const;
+    TCandidates uniquePaths( TCandidates && files ) const;
+    TCandidates sameHash( TCandidates && files ) const;
+    void hash( TCandidates & files, bool fullHash );
+
+    QByteArray sampleHash( const QString & path, qint64 size );
+    QByteArray fullHash( const QString & path );
+
+    QStringList fRootDirs;
+    QStringList fNameFilters;
+    std::atomic< EStage > fStage{ eWalking };
+    std::atomic< int > fProgress{ 0 };
+    std::atomic< int > fProgressTotal{ 0 };
+    std::atomic< qint64 > fBytesRead{ 0 };
+    std::vector< SDuplicateGroup > fDuplicates;
+    SDuplicateStatistics fStatistics;
+};
+
+#endif
@@ -22,23 +22,41 @@
 
 #include "MainWindow.h"
 #include "DirModel.h"
+#include "DuplicateFinder.h"
+#include "MovieIDIndex.h"
+#include "MediaProbe.h"
 #include "SABUtils/utils.h"
 #include "SABUtils/ScrollMessageBox.h"
 #include "SABUtils/ButtonEnabler.h"
+#include "Common/Trace.h"
+#include "Common/DirCompleter.h"
+#include "Common/Log.h"
+#include "Common/ScanStats.h"
+#include "Common/ScanStatsPanel.h"
 #include "ui_MainWindow.h"
 
 #include <QSettings>
 #include <QFileInfo>
 #include <QFileDialog>
-#include <QCompleter>
 #include <QMessageBox>
-#include <QDateTime>
 #include <QDate>
 #include <QDesktopServices> 
 #include <QTimer>
 #include <QProgressDialog>
 #include <QScrollBar>
-#include <QDebug>
+#include <QLocale>
+#include <QStatusBar>
+#include <QStorageInfo>
+#include <QPushButton>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <map>
+
+static NLog::CCategory sLog( "mainwindow" );
+static const size_t kItemsPerPass = 200; // folders, each is a few items
 
 CMainWindow::CMainWindow(QWidget* parent)
     : QMainWindow(parent),
@@ -51,30 +69,43 @@ CMainWindow::CMainWindow(QWidget* parent)
     connect(fImpl->dir, &NSABUtils::CDelayLineEdit::sigTextChangedAfterDelay, this, &CMainWindow::slotDirectoryChanged);
     connect(fImpl->btnSelectDir, &QPushButton::clicked, this, &CMainWindow::slotSelectDirectory);
     connect(fImpl->btnTransform, &QPushButton::clicked, this, &CMainWindow::slotTransform);
+    connect(fImpl->btnFindDuplicates, &QPushButton::clicked, this, &CMainWindow::slotFindDuplicates);
+    connect(fImpl->btnRankVersions, &QPushButton::clicked, this, &CMainWindow::slotRankVersions);
+    connect(fImpl->btnAddDir, &QToolButton::clicked, this, &CMainWindow::slotAddDirectory);
+    connect(fImpl->btnRemoveDir, &QToolButton::clicked, this, &CMainWindow::slotRemoveDirectories);
+
+    auto completer = new CDirCompleter(this);
+    completer->addLineEdit(fImpl->dir);
 
-    auto completer = new QCompleter(this);
-    auto fsModel = new QFileSystemModel(completer);
-    fsModel->setRootPath("");
-    completer->setModel(fsModel);
-    completer->setCompletionMode(QCompleter::PopupCompletion);
-    completer->setCaseSensitivity(Qt::CaseInsensitive);
+    fStatsPanel = new CScanStatsPanel( this );
+    addDockWidget( Qt::BottomDockWidgetArea, fStatsPanel );
+    menuBar()->addMenu( tr( "&View" ) )->addAction( fStatsPanel->toggleViewAction() );
+    restoreState( QSettings().value( "WindowState" ).toByteArray() );
 
-    fImpl->dir->setCompleter(completer);
+    fLoadTimer = new QTimer( this );
+    fLoadTimer->setSingleShot( true );
+    connect( fLoadTimer, &QTimer::timeout, this, &CMainWindow::slotShowFound );
+
+    fCancelLoad = new QPushButton( tr( "Cancel" ), this );
+    fCancelLoad->setVisible( false );
+    statusBar()->addPermanentWidget( fCancelLoad );
+    connect( fCancelLoad, &QPushButton::clicked, this, &CMainWindow::slotCancelLoad );
 
     QTimer::singleShot(0, this, &CMainWindow::slotDirectoryChanged);
 
     connect( fImpl->menubar, &NSABUtils::CMenuBarEx::sigAboutToEngage, []() 
              { 
-                 qDebug() << QDateTime::currentDateTime().toString() << "Menubar engaged"; 
+                 LOG_DEBUG( sLog, "Menubar engaged" );
              } );
     connect( fImpl->menubar, &NSABUtils::CMenuBarEx::sigFinishedEngagement, []()
              { 
-                 qDebug() << QDateTime::currentDateTime().toString() << "Menubar disengaged"; 
+                 LOG_DEBUG( sLog, "Menubar disengaged" );
              } );
 }
 
 CMainWindow::~CMainWindow()
 {
+    stopLoading();
     saveSettings();
 }
 
@@ -83,6 +114,7 @@ void CMainWindow::loadSettings()
     QSettings settings;
 
     fImpl->dir->setText( settings.value( "Directory", QString() ).toString() );
+    fImpl->extraDirs->addItems( settings.value( "ExtraDirectories", QStringList() ).toStringList() );
 }
 
 void CMainWindow::saveSettings()
@@ -90,13 +122,17 @@ void CMainWindow::saveSettings()
     QSettings settings;
 
     settings.setValue("Directory", fImpl->dir->text());
+
+    QStringList extraDirs;
+    for ( int ii = 0; ii < fImpl->extraDirs->count(); ++ii )
+        extraDirs << fImpl->extraDirs->item( ii )->text();
+    settings.setValue( "ExtraDirectories", extraDirs );
+    settings.setValue( "WindowState", saveState() );
 }
 
 void CMainWindow::slotDirectoryChanged()
 {
-    QFileInfo dir(fImpl->dir->text());
-    bool aOK = !fImpl->dir->text().isEmpty() && dir.exists() && dir.isDir();
-    if ( aOK )
+    if ( !rootDirs().isEmpty() )
         QTimer::singleShot(0, this, &CMainWindow::slotLoad);
 }
 
@@ -107,6 +143,77 @@ void CMainWindow::slotSelectDirectory()
         fImpl->dir->setText( dir );
 }
 
+void CMainWindow::slotAddDirectory()
+{
+    auto dir = QFileDialog::getExistingDirectory( this, tr( "Select Directory:" ), fImpl->dir->text() );
+    if ( dir.isEmpty() || !fImpl->extraDirs->findItems( dir, Qt::MatchExactly ).isEmpty() )
+        return;
+    fImpl->extraDirs->addItem( dir );
+    slotDirectoryChanged();
+}
+
+void CMainWindow::slotRemoveDirectories()
+{
+    auto selected = fImpl->extraDirs->selectedItems();
+    if ( selected.isEmpty() )
+        return;
+    qDeleteAll( selected );
+    slotDirectoryChanged();
+}
+
+QStringList CMainWindow::rootDirs() const
+{
+    QStringList dirs;
+    dirs << fImpl->dir->text();
+    for ( int ii = 0; ii < fImpl->extraDirs->count(); ++ii )
+        dirs << fImpl->extraDirs->item( ii )->text();
+
+    // canonical, so the same directory reached through a link or a different spelling is only walked once
+    QStringList canonical;
+    for ( auto && ii : dirs )
+    {
+        QFileInfo fi( ii );
+        if ( ii.isEmpty() || !fi.exists() || !fi.isDir() )
+            continue;
+        canonical << fi.canonicalFilePath();
+    }
+
+#ifdef Q_OS_WIN
+    auto cs = Qt::CaseInsensitive;
+#else
+    auto cs = Qt::CaseSensitive;
+#endif
+    canonical.sort( cs );
+
+    // a root inside another root would be walked, and every movie in it found, twice.  Sorted, a parent comes before its children
+    QStringList retVal;
+    for ( auto && ii : canonical )
+    {
+        auto nested = false;
+        for ( auto && jj : retVal )
+        {
+            auto parent = jj.endsWith( "/" ) ? jj : ( jj + "/" );
+            if ( ( ii.compare( jj, cs ) == 0 ) || ii.startsWith( parent, cs ) )
+            {
+                nested = true;
+                break;
+            }
+        }
+        if ( !nested )
+            retVal << ii;
+    }
+    return retVal;
+}
+
+QString CMainWindow::displayPath( const QString & absPath ) const
+{
+    // relative to the main directory, anything from the other roots stays absolute
+    auto relPath = QDir( QFileInfo( fImpl->dir->text() ).canonicalFilePath() ).relativeFilePath( absPath );
+    if ( relPath.startsWith( ".." ) || QDir::isAbsolutePath( relPath ) )
+        return absPath;
+    return relPath;
+}
+
 void CMainWindow::slotLoad()
 {
     loadDirectory();
@@ -114,163 +221,143 @@ void CMainWindow::slotLoad()
 
 void CMainWindow::loadDirectory()
 {
-    QApplication::setOverrideCursor(Qt::WaitCursor);
+    TRACE_SCOPE( "scan", "CMainWindow::loadDirectory" );
+    stopLoading();
+    fStatsPanel->startScan();
 
     fIDMap.clear();
-    fDirMap.clear();
     fImpl->directories->clear();
     fImpl->directories->setHeaderLabels(QStringList() << "ID" << "Name");
     auto header = fImpl->directories->header();
     header->setSectionResizeMode(QHeaderView::ResizeToContents);
+    // the view sorts once everything is in, not on every insert
+    fImpl->directories->setSortingEnabled( false );
 
-    QProgressDialog dlg(tr("Computing Number of Directories..."), "Cancel", 0, 0, this);
-    dlg.setMinimumDuration(0);
-    dlg.setValue(1);
-
-    //int numDirs = getNumDirs( fImpl->dir->text(), &dlg );
-    //if (dlg.wasCanceled())
-    //    return;
-    dlg.setLabelText(tr("Finding Directories..."));
-    dlg.setRange(0, 0);
-    dlg.setValue(0);
+    fLoadedIndex = std::make_unique< CMovieIDIndex >();
+    fFound = std::make_shared< CBatchQueue< SFoundFolder > >();
+    fCanceled = false;
+    fChecked = 0;
 
-    QDirIterator ii(fImpl->dir->text(), QStringList() << "*.mkv", QDir::Filter::AllDirs | QDir::NoDotAndDotDot | QDir::NoSymLinks | QDir::Files, QDirIterator::IteratorFlag::Subdirectories);
+    // one walker per volume, roots sharing a volume are walked one after the other so they don't fight over the same disk
+    std::map< QString, QStringList > volumes;
+    for ( auto && ii : rootDirs() )
+        volumes[ QStorageInfo( ii ).rootPath() ] << ii;
 
-    auto relToDir = QDir(fImpl->dir->text());
-
-    int cnt = 0;
-    while (ii.hasNext())
+    for ( auto && ii : volumes )
     {
-        if (dlg.wasCanceled())
-            break;
-        ii.next();
-        if ( skipDir(ii.fileName() ) )
-            continue;
-        cnt++;
-        dlg.setValue(cnt);
-        qApp->processEvents();
-
-        auto info = ii.fileInfo();
-
-        QRegularExpression regExp("(?<name>.*)\\s\\(.*\\[(tmdbid|imdbid)\\=\\s*(?<id>.*)\\s*\\]");
-        auto leafName = info.fileName();
-        auto match = regExp.match(leafName);
-
-        auto relPath = relToDir.relativeFilePath( ii.filePath() );
-
-        if ( info.isDir() )
-        {
-            qDebug() << ii.filePath();
-            QTreeWidgetItem *idItem = nullptr;
-            if ( match.hasMatch() )
+        fLoadTasks.push_back( std::async( std::launch::async, [ this, roots = ii.second, found = fFound ]()
             {
-                auto id = match.captured( "id" );
-                auto name = match.captured( "name" );
-                auto pos = fIDMap.find( id );
-                if ( pos == fIDMap.end() )
+                for ( auto && jj : roots )
                 {
-                    idItem = new QTreeWidgetItem( fImpl->directories, QStringList() << id << name, ENodeType::eID );
-                    idItem->setExpanded( true );
-                    fIDMap[id] = idItem;
+                    // each folder is handed to the window as soon as it is complete, the index is only used for its walk
+                    CMovieIDIndex index;
+                    index.scan( jj, [ this ]( int ) { fChecked += 100; return !fCanceled; }, [ &found ]( SFoundFolder && folder ) { found->push( std::move( folder ) ); } );
                 }
-                else
-                    idItem = ( *pos ).second;
-            }
-            else
-            {
-                continue;
-            }
+            } ) );
+    }
 
-            auto dirItem = new QTreeWidgetItem( idItem, QStringList() << QString() << relPath, ENodeType::eDir );
-            fDirMap[ii.filePath()] = dirItem;
-            dirItem->setExpanded( true );
-            idItem->setHidden( idItem->childCount() < 2 );
-        }
-        else
-        {
-            auto dirName = info.absolutePath();
-            auto pos = fDirMap.find( dirName );
-            //Q_ASSERT( pos != fDirMap.end() );
-            if ( pos == fDirMap.end() )
-                continue;
+    setLoading( true );
+    fLoadTimer->start( 0 );
+}
 
-            auto fileItem = new QTreeWidgetItem( (*pos).second, QStringList() << QString() << relPath, ENodeType::eFile );
-        }
-    }
+void CMainWindow::stopLoading()
+{
+    fLoadTimer->stop();
+    fCanceled = true;
+    for ( auto && ii : fLoadTasks )
+        ii.wait();
+    fLoadTasks.clear();
+    fFound.reset();
+}
 
-    for( auto ii = 0; ii < fImpl->directories->topLevelItemCount(); ++ii )
-    {
-        auto item = fImpl->directories->topLevelItem( ii );
-        if ( item->isHidden() )
-            continue;
-        validateFiles( item );
-    }
-    QApplication::restoreOverrideCursor();
-    qApp->processEvents();
+void CMainWindow::setLoading( bool loading )
+{
+    fImpl->btnTransform->setEnabled( !loading );
+    fImpl->btnFindDuplicates->setEnabled( !loading );
+    fImpl->btnRankVersions->setEnabled( !loading );
+    fCancelLoad->setVisible( loading );
+    if ( loading )
+        statusBar()->showMessage( tr( "Finding Directories..." ) );
+    else
+        statusBar()->clearMessage();
 }
 
-void CMainWindow::validateFiles( QTreeWidgetItem * idItem ) 
+void CMainWindow::slotShowFound()
 {
-    if ( !idItem )
-        return;
-    for( auto ii = 0; ii < idItem->childCount(); ++ii )
+    // checked before taking what was found, so nothing pushed after the last take can be missed
+    bool finished = std::all_of( fLoadTasks.begin(), fLoadTasks.end(), []( const std::future< void > & task ) { return task.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready; } );
+    // a bounded batch per pass, the event loop gets a turn in between even when the walk is far ahead
+    addFolders( fFound->take( kItemsPerPass ) );
+    if ( !finished || !fFound->empty() )
     {
-        auto dirItem = idItem->child( ii );
+        statusBar()->showMessage( tr( "Finding Directories (%1 checked, %2 groups)..." ).arg( fChecked.load() ).arg( static_cast< int >( fIDMap.size() ) ) );
+        fLoadTimer->start( fFound->empty() ? 100 : 0 );
+        return;
+    }
 
-        auto dirLeafName = QFileInfo( dirItem->text( 1 ) ).fileName();
+    fLoadTasks.clear();
+    fFound.reset();
+    fImpl->directories->setSortingEnabled( true );
+    fStatsPanel->finishScan();
+    setLoading( false );
+    emit sigLoadFinished();
+}
 
-        QRegularExpression regExp( "(?<name>.*)\\s\\(.*\\)\\s*-\\s*(?<extraInfo>.*)\\s*\\[(tmdbid|imdbid)\\=\\s*(?<id>.*)\\s*\\]" );
-        auto match = regExp.match( dirLeafName );
-        bool outOfOrder = false;
-        if ( !match.hasMatch() )
-        {
-            QRegularExpression regExp( "(?<name>.*)\\s\\(.*\\)\\s*\\[(tmdbid|imdbid)\\=\\s*(?<id>.*)\\s*\\]\\s*-\\s*(?<extraInfo>.*)" );
-            match = regExp.match( dirLeafName );
-            if ( !match.hasMatch() )
-                continue; // happens when its the base version
-            outOfOrder = true;
-        }
-        Q_ASSERT( dirItem->childCount() == 1 );
-        auto baseName = match.captured( "name" ).trimmed();
-        auto extraInfo = match.captured( "extraInfo" ).trimmed();
+void CMainWindow::slotCancelLoad()
+{
+    // what was found so far stays in the tree
+    stopLoading();
+    fImpl->directories->setSortingEnabled( true );
+    fStatsPanel->finishScan();
+    setLoading( false );
+    statusBar()->showMessage( tr( "Canceled" ), 5000 );
+}
 
-        auto correctFileName2 = QString( "%1 - %2" ).arg( baseName ).arg( extraInfo );
-        auto correctFileName1 = QString( "%1-%2" ).arg( baseName ).arg( extraInfo );
+void CMainWindow::addFolders( std::vector< SFoundFolder > && folders )
+{
+    TRACE_SCOPE( "classify", "CMainWindow::addFolders" );
+    SCAN_PHASE( "items" );
+    int numItems = 0;
+    for ( auto && ii : folders )
+    {
+        auto id = ii.fID;
+        auto && group = fLoadedIndex->add( std::move( ii ) );
+        if ( group.fFolders.size() < 2 )
+            continue;
 
-        auto fileItem = dirItem->child( 0 );
-        auto filePath = fileItem->text( 1 );
-        auto fileName = QFileInfo( filePath ).baseName();
-        if ( outOfOrder || ( fileName != correctFileName1 ) && ( fileName != correctFileName2 ) )
+        // only the IDs with more than one folder are shown, the first folder waits until the second turns up
+        auto pos = fIDMap.find( id );
+        if ( pos == fIDMap.end() )
         {
-            delete fileItem;
-            fileItem = new QTreeWidgetItem( dirItem, QStringList() << QString() << filePath, ENodeType::eBadFileName );
-            fileItem->setBackground( 1, Qt::red );
+            auto idItem = new QTreeWidgetItem( fImpl->directories, QStringList() << id << group.fName, ENodeType::eID );
+            idItem->setExpanded( true );
+            numItems++;
+            pos = fIDMap.insert( std::make_pair( id, idItem ) ).first;
+            for ( auto && jj : group.fFolders )
+                numItems += addFolderItem( ( *pos ).second, jj );
         }
+        else
+            numItems += addFolderItem( ( *pos ).second, group.fFolders.back() );
     }
+    NScanStats::add( NScanStats::eItemsCreated, numItems );
 }
-bool CMainWindow::hasChildDirs(const QFileInfo& info) const
+
+int CMainWindow::addFolderItem( QTreeWidgetItem * idItem, const SMovieFolder & folder )
 {
-    QDirIterator jj(info.absoluteFilePath(), QStringList() << "*.*" << "*", QDir::Filter::AllDirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
-    return jj.hasNext();
+    auto dirItem = new QTreeWidgetItem( idItem, QStringList() << QString() << displayPath( folder.fPath ), ENodeType::eDir );
+    dirItem->setExpanded( true );
+    for ( auto && ii : folder.fFiles )
+    {
+        auto fileItem = new QTreeWidgetItem( dirItem, QStringList() << QString() << displayPath( ii.fPath ), ii.fBadFileName ? ENodeType::eBadFileName : ENodeType::eFile );
+        if ( ii.fBadFileName )
+            fileItem->setBackground( 1, Qt::red );
+    }
+    return 1 + static_cast< int >( folder.fFiles.size() );
 }
 
 bool CMainWindow::skipDir(const QString& path) const
 {
-    if (path.contains("Featurettes"))
-        return true;
-    if (path.contains("SRT"))
-        return true;
-    if (path.contains("Artwork"))
-        return true;
-    if (path.contains("Extras"))
-        return true;
-    if (path.contains("eaDir"))
-        return true;
-    if (path.contains("Subs"))
-        return true;
-    if (path.contains("subs"))
-        return true;
-    return false;
+    return CMovieIDIndex::skipDir( path );
 }
 
 QTreeWidgetItem * CMainWindow::getItem( const QString & path ) const
@@ -293,30 +380,9 @@ QTreeWidgetItem* CMainWindow::getParent(const QFileInfo & fileInfo ) const
     return getItem(path);
 }
 
-int CMainWindow::getNumDirs(const QString& dir, QProgressDialog * dlg ) const
-{
-    qApp->processEvents();
-    QDirIterator ii(dir, QStringList() << "*.*" << "*", QDir::Filter::AllDirs | QDir::NoDotAndDotDot | QDir::NoSymLinks, QDirIterator::IteratorFlag::Subdirectories);
-
-    int cnt = 0;
-    while (ii.hasNext())
-    {
-        ii.next();
-        if (dlg->wasCanceled())
-            break;
-
-        if (skipDir(ii.fileName()))
-            continue;
-
-        if ( cnt % 100 == 0 )
-            qApp->processEvents();
-        cnt++;
-    }
-    return cnt;
-}
-
 void CMainWindow::slotTransform()
 {
+    TRACE_SCOPE( "rename", "CMainWindow::slotTransform" );
     QProgressDialog dlg(tr("Computing Number of Directories to Rename..."), "Cancel", 0, 0, this);
     dlg.setMinimumDuration(0);
     dlg.setValue(1);
@@ -369,19 +435,11 @@ void CMainWindow::transform( QTreeWidgetItem * fileItem, int /*pos*/, QProgressD
 
         auto dirLeafName = QFileInfo( dirItem->text( 1 ) ).fileName();
 
-        QRegularExpression regExp( "(?<name>.*)\\s\\(.*\\)\\s*-\\s*(?<extraInfo>.*)\\s*\\[(tmdbid|imdbid)\\=\\s*(?<id>.*)\\s*\\]" );
-        auto match = regExp.match( dirLeafName );
-        if ( !match.hasMatch() ) // happens when its the base version shouldnt happen here since the file would be ok...
-        {
-            QRegularExpression regExp( "(?<name>.*)\\s\\(.*\\)\\s*\\[(tmdbid|imdbid)\\=\\s*(?<id>.*)\\s*\\]\\s*-\\s*(?<extraInfo>.*)" );
-            match = regExp.match( dirLeafName );
-        }
-
-        if ( match.hasMatch() ) // happens when its the base version shouldnt happen here since the file would be ok...
+        QString baseName;
+        QString extraInfo;
+        bool outOfOrder;
+        if ( CMovieIDIndex::splitVersionName( dirLeafName, baseName, extraInfo, outOfOrder ) ) // fails for the base version, shouldnt happen here since the file would be ok...
         {
-            auto baseName = match.captured( "name" ).trimmed();
-            auto extraInfo = match.captured( "extraInfo" ).trimmed();
-
             auto correctFileName = QString( "%1 - %2" ).arg( baseName ).arg( extraInfo );
 
             auto filePath = fileItem->text( 1 );
@@ -410,6 +468,179 @@ void CMainWindow::transform( QTreeWidgetItem * fileItem, int /*pos*/, QProgressD
     }
 }
 
+void CMainWindow::slotFindDuplicates()
+{
+    TRACE_SCOPE( "hash", "CMainWindow::slotFindDuplicates" );
+    auto roots = rootDirs();
+    if ( roots.isEmpty() )
+        return;
 
+    QProgressDialog dlg( tr( "Finding Movies..." ), "Cancel", 0, 0, this );
+    dlg.setMinimumDuration( 0 );
+    dlg.setValue( 0 );
+
+    CDuplicateFinder finder( roots, QStringList() << "*.mkv" << "*.mp4" << "*.m4v" << "*.avi", this );
+    finder.start();
+    while ( !finder.wait( 50 ) )
+    {
+        if ( dlg.wasCanceled() )
+            finder.requestInterruption();
 
+        switch ( finder.stage() )
+        {
+            case CDuplicateFinder::eWalking:
+                dlg.setLabelText( tr( "Finding Movies (%1 found)..." ).arg( finder.progress() ) );
+                break;
+            case CDuplicateFinder::eSampling:
+                dlg.setLabelText( tr( "Comparing Movies of the Same Size..." ) );
+                dlg.setRange( 0, finder.progressTotal() );
+                dlg.setValue( finder.progress() );
+                break;
+            case CDuplicateFinder::eHashing:
+                dlg.setLabelText( tr( "Verifying Possible Duplicates..." ) );
+                dlg.setRange( 0, finder.progressTotal() );
+                dlg.setValue( finder.progress() );
+                break;
+            case CDuplicateFinder::eDone:
+                break;
+        }
+        qApp->processEvents();
+    }
+    if ( dlg.wasCanceled() )
+        return;
+    dlg.close();
 
+    showDuplicates( finder.duplicates() );
+
+    QLocale locale;
+    auto && stats = finder.statistics();
+    statusBar()->showMessage( tr( "%1 duplicate groups in %2 movies, read %3 of %4 in %5 seconds" )
+                              .arg( static_cast< int >( finder.duplicates().size() ) ).arg( stats.fFiles )
+                              .arg( locale.formattedDataSize( stats.fBytesRead ) ).arg( locale.formattedDataSize( stats.fBytesTotal ) )
+                              .arg( stats.fMS / 1000.0, 0, 'f', 1 ) );
+}
+
+void CMainWindow::showDuplicates( const std::vector< SDuplicateGroup > & duplicates )
+{
+    for ( auto ii = fImpl->directories->topLevelItemCount() - 1; ii >= 0; --ii )
+    {
+        auto item = fImpl->directories->topLevelItem( ii );
+        if ( item->type() == ENodeType::eDuplicates )
+            delete item;
+    }
+
+    QLocale locale;
+    for ( auto && ii : duplicates )
+    {
+        auto groupItem = new QTreeWidgetItem( fImpl->directories, QStringList() << tr( "Duplicate" ) << tr( "%1 copies of %2" ).arg( ii.fPaths.count() ).arg( locale.formattedDataSize( ii.fSize ) ), ENodeType::eDuplicates );
+        groupItem->setExpanded( true );
+        for ( auto && jj : ii.fPaths )
+        {
+            auto fileItem = new QTreeWidgetItem( groupItem, QStringList() << QString() << displayPath( jj ), ENodeType::eDuplicateFile );
+            fileItem->setBackground( 1, Qt::yellow );
+        }
+    }
+}
+
+void CMainWindow::slotRankVersions()
+{
+    TRACE_SCOPE( "probe", "CMainWindow::slotRankVersions" );
+    // the first movie of each version's folder, grouped by ID
+    std::vector< std::vector< std::pair< QTreeWidgetItem *, QString > > > groups;
+    size_t numFiles = 0;
+    for ( auto ii = 0; ii < fImpl->directories->topLevelItemCount(); ++ii )
+    {
+        auto idItem = fImpl->directories->topLevelItem( ii );
+        if ( idItem->type() != ENodeType::eID )
+            continue;
+
+        std::vector< std::pair< QTreeWidgetItem *, QString > > group;
+        for ( auto jj = 0; jj < idItem->childCount(); ++jj )
+        {
+            auto dirItem = idItem->child( jj );
+            if ( dirItem->childCount() == 0 )
+                continue;
+            group.push_back( std::make_pair( dirItem, QDir( fImpl->dir->text() ).absoluteFilePath( dirItem->child( 0 )->text( 1 ) ) ) );
+        }
+        numFiles += group.size();
+        groups.push_back( group );
+    }
+    if ( numFiles == 0 )
+        return;
+
+    QProgressDialog dlg( tr( "Reading Movie Headers..." ), "Cancel", 0, static_cast< int >( numFiles ), this );
+    dlg.setMinimumDuration( 0 );
+    dlg.setValue( 0 );
+
+    // only the headers are read, so every file of every group is probed at once
+    std::vector< std::vector< SMediaInfo > > infos( groups.size() );
+    std::vector< std::pair< size_t, size_t > > work;
+    for ( size_t ii = 0; ii < groups.size(); ++ii )
+    {
+        infos[ ii ].resize( groups[ ii ].size() );
+        for ( size_t jj = 0; jj < groups[ ii ].size(); ++jj )
+            work.push_back( std::make_pair( ii, jj ) );
+    }
+
+    std::atomic< size_t > next{ 0 };
+    std::atomic< int > done{ 0 };
+    std::atomic< bool > canceled{ false };
+    std::vector< std::future< void > > tasks;
+    auto numTasks = std::max( 1, std::min( QThread::idealThreadCount(), static_cast< int >( work.size() ) ) );
+    for ( int ii = 0; ii < numTasks; ++ii )
+    {
+        tasks.push_back( std::async( std::launch::async, [ &groups, &infos, &work, &next, &done, &canceled ]()
+            {
+                for ( auto jj = next++; ( jj < work.size() ) && !canceled; jj = next++ )
+                {
+                    auto && curr = work[ jj ];
+                    infos[ curr.first ][ curr.second ] = CMediaProbe::probe( groups[ curr.first ][ curr.second ].second );
+                    done++;
+                }
+            } ) );
+    }
+
+    for ( auto && ii : tasks )
+    {
+        while ( ii.wait_for( std::chrono::milliseconds( 50 ) ) != std::future_status::ready )
+        {
+            dlg.setValue( done );
+            qApp->processEvents();
+            if ( dlg.wasCanceled() )
+                canceled = true;
+        }
+    }
+    if ( canceled )
+        return;
+    dlg.setValue( static_cast< int >( numFiles ) );
+
+    fImpl->directories->setHeaderLabels( QStringList() << "ID" << "Name" << "Rank" << "Resolution" << "Video" << "Audio" << "Duration" << "Bitrate" << "Size" );
+    QLocale locale;
+    qint64 bytesRead = 0;
+    for ( size_t ii = 0; ii < groups.size(); ++ii )
+    {
+        auto order = CMediaProbe::rank( infos[ ii ] );
+        for ( size_t rank = 0; rank < order.size(); ++rank )
+        {
+            auto && info = infos[ ii ][ order[ rank ] ];
+            auto dirItem = groups[ ii ][ order[ rank ] ].first;
+            bytesRead += info.fBytesRead;
+
+            dirItem->setText( 2, info.fValid ? QString::number( static_cast< int >( rank ) + 1 ) : tr( "Unreadable" ) );
+            dirItem->setToolTip( 2, info.fError );
+            dirItem->setText( 3, info.resolution() );
+            dirItem->setText( 4, info.fVideoCodec );
+            dirItem->setText( 5, info.fAudioChannels ? tr( "%1 %2ch" ).arg( info.fAudioCodec ).arg( info.fAudioChannels ) : info.fAudioCodec );
+            dirItem->setText( 6, info.fDuration > 0 ? QTime( 0, 0 ).addSecs( static_cast< int >( info.fDuration ) ).toString( "h:mm:ss" ) : QString() );
+            dirItem->setText( 7, info.fBitrate ? tr( "%1 Mb/s" ).arg( info.fBitrate / 1000000.0, 0, 'f', 1 ) : QString() );
+            dirItem->setText( 8, locale.formattedDataSize( info.fSize ) );
+            if ( !info.fValid )
+                dirItem->setBackground( 2, Qt::red );
+            else if ( rank == 0 )
+                dirItem->setBackground( 2, Qt::green );
+            else
+                dirItem->setBackground( 2, QBrush() );
+        }
+    }
+    statusBar()->showMessage( tr( "Ranked %1 versions, read %2 of headers" ).arg( static_cast< int >( numFiles ) ).arg( locale.formattedDataSize( bytesRead ) ) );
+}
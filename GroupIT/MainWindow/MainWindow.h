@@ -23,9 +23,21 @@
 #ifndef _MAINWINDOW_H
 #define _MAINWINDOW_H
 
+#include "Common/BatchQueue.h"
+#include <vector>
+#include <atomic>
+#include <future>
+#include <memory>
 class QTreeWidgetItem;
 class QFileInfo;
 class QProgressDialog;
+class QTimer;
+class QPushButton;
+struct SDuplicateGroup;
+struct SFoundFolder;
+struct SMovieFolder;
+class CMovieIDIndex;
+class CScanStatsPanel;
 #include <QMainWindow>
 
 namespace Ui {class CMainWindow;};
@@ -39,7 +51,9 @@ public:
         eID = 1000,
         eDir,
         eFile,
-        eBadFileName
+        eBadFileName,
+        eDuplicates,
+        eDuplicateFile
     };
 
     CMainWindow(QWidget* parent = 0);
@@ -49,27 +63,48 @@ public Q_SLOTS:
     void slotDirectoryChanged();
     void slotLoad();
     void slotTransform();
-
+    void slotFindDuplicates();
+    void slotRankVersions();
+    void slotAddDirectory();
+    void slotRemoveDirectories();
+Q_SIGNALS:
+    // the progressive load has shown everything it found
+    void sigLoadFinished();
+private Q_SLOTS:
+    void slotShowFound();
+    void slotCancelLoad();
 private:
     void loadSettings();
     void saveSettings();
     void loadDirectory();
 
-    void validateFiles( QTreeWidgetItem *idItem );
-
-    bool hasChildDirs(const QFileInfo& info ) const;
+    void stopLoading();
+    void setLoading( bool loading );
+    void addFolders( std::vector< SFoundFolder > && folders );
+    int addFolderItem( QTreeWidgetItem * idItem, const SMovieFolder & folder );
+    QStringList rootDirs() const;
+    QString displayPath( const QString & absPath ) const;
+    void showDuplicates( const std::vector< SDuplicateGroup > & duplicates );
 
     bool skipDir(const QString& path) const;
     void transform(QTreeWidgetItem* item, int pos, QProgressDialog * dlg);
 
-    int getNumDirs( const QString & dir, QProgressDialog * dlg ) const;
     int getNumDirsToRename(QProgressDialog* dlg, QTreeWidgetItem* parent = nullptr) const;
 
     QTreeWidgetItem* getItem(const QString & info) const;
     QTreeWidgetItem* getParent(const QFileInfo& info) const;
 
     std::unordered_map< QString, QTreeWidgetItem* > fIDMap;
-    std::unordered_map< QString, QTreeWidgetItem * > fDirMap;
+    CScanStatsPanel* fStatsPanel{ nullptr };
+
+    // the walkers run until they have covered every root, what they find is shown from fLoadTimer as it arrives
+    std::unique_ptr< CMovieIDIndex > fLoadedIndex;
+    std::shared_ptr< CBatchQueue< SFoundFolder > > fFound;
+    std::vector< std::future< void > > fLoadTasks;
+    std::atomic< bool > fCanceled{ false };
+    std::atomic< int > fChecked{ 0 };
+    QTimer* fLoadTimer{ nullptr };
+    QPushButton* fCancelLoad{ nullptr };
 
     std::unique_ptr< Ui::CMainWindow > fImpl;
 };
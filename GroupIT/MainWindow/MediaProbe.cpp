@@ -0,0 +1,518 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "MediaProbe.h"
+#include "Common/Trace.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace
+{
+    const qint64 kMaxElementSize = 8 * 1024 * 1024; // Info, Tracks, SeekHead and the small MP4 boxes are far smaller
+
+    class CReader
+    {
+    public:
+        CReader( QFile & file, SMediaInfo & info ) :
+            fFile( file ),
+            fInfo( info )
+        {
+        }
+
+        qint64 size() const { return fFile.size(); }
+
+        QByteArray read( qint64 pos, qint64 len )
+        {
+            if ( ( len <= 0 ) || ( len > kMaxElementSize ) || !fFile.seek( pos ) )
+                return QByteArray();
+            auto retVal = fFile.read( len );
+            fInfo.fBytesRead += retVal.size();
+            return retVal;
+        }
+    private:
+        QFile & fFile;
+        SMediaInfo & fInfo;
+    };
+
+    quint64 readUInt( const uchar * data, qint64 len )
+    {
+        quint64 retVal = 0;
+        for ( qint64 ii = 0; ii < std::min< qint64 >( len, 8 ); ++ii )
+            retVal = ( retVal << 8 ) | data[ ii ];
+        return retVal;
+    }
+
+    QString normalizeCodec( const QString & codec )
+    {
+        auto upper = codec.toUpper();
+        if ( upper.contains( "HEVC" ) || ( upper == "HVC1" ) || ( upper == "HEV1" ) )
+            return "HEVC";
+        if ( upper.contains( "AVC" ) || ( upper == "AVC1" ) || ( upper == "AVC3" ) )
+            return "AVC";
+        if ( upper.contains( "AV1" ) || ( upper == "AV01" ) )
+            return "AV1";
+        if ( upper.contains( "VP9" ) || ( upper == "VP09" ) )
+            return "VP9";
+        if ( upper.contains( "MPEG2" ) || ( upper == "MP2V" ) )
+            return "MPEG2";
+        if ( upper.startsWith( "A_" ) || upper.startsWith( "V_" ) )
+            return upper.mid( 2 );
+        return upper;
+    }
+
+    // EBML
+
+    const quint64 kEBMLHeader = 0x1A45DFA3;
+    const quint64 kSegment = 0x18538067;
+    const quint64 kSeekHead = 0x114D9B74;
+    const quint64 kSeek = 0x4DBB;
+    const quint64 kSeekID = 0x53AB;
+    const quint64 kSeekPosition = 0x53AC;
+    const quint64 kInfo = 0x1549A966;
+    const quint64 kTimecodeScale = 0x2AD7B1;
+    const quint64 kDuration = 0x4489;
+    const quint64 kTracks = 0x1654AE6B;
+    const quint64 kTrackEntry = 0xAE;
+    const quint64 kTrackType = 0x83;
+    const quint64 kCodecID = 0x86;
+    const quint64 kVideo = 0xE0;
+    const quint64 kPixelWidth = 0xB0;
+    const quint64 kPixelHeight = 0xBA;
+    const quint64 kAudio = 0xE1;
+    const quint64 kChannels = 0x9F;
+    const quint64 kCluster = 0x1F43B675;
+
+    struct SElement
+    {
+        quint64 fID{ 0 };
+        qint64 fSize{ 0 };
+        bool fUnknownSize{ false };
+        int fHeaderSize{ 0 };
+    };
+
+    // variable length integer, IDs keep their length marker, sizes don't
+    bool readVInt( const uchar * data, qint64 avail, bool isID, quint64 & value, int & len, bool * allOnes = nullptr )
+    {
+        if ( ( avail < 1 ) || ( data[ 0 ] == 0 ) )
+            return false;
+
+        len = 1;
+        uchar mask = 0x80;
+        while ( !( data[ 0 ] & mask ) )
+        {
+            mask >>= 1;
+            ++len;
+        }
+        if ( ( len > avail ) || ( isID && ( len > 4 ) ) )
+            return false;
+
+        value = isID ? data[ 0 ] : ( data[ 0 ] & ( mask - 1 ) );
+        auto ones = ( data[ 0 ] & ( mask - 1 ) ) == ( mask - 1 );
+        for ( int ii = 1; ii < len; ++ii )
+        {
+            value = ( value << 8 ) | data[ ii ];
+            ones = ones && ( data[ ii ] == 0xFF );
+        }
+        if ( allOnes )
+            *allOnes = ones;
+        return true;
+    }
+
+    bool readElement( const uchar * data, qint64 avail, SElement & element )
+    {
+        int idLen = 0;
+        int sizeLen = 0;
+        quint64 size = 0;
+        if ( !readVInt( data, avail, true, element.fID, idLen ) || !readVInt( data + idLen, avail - idLen, false, size, sizeLen, &element.fUnknownSize ) )
+            return false;
+        element.fSize = static_cast< qint64 >( size );
+        element.fHeaderSize = idLen + sizeLen;
+        return element.fUnknownSize || ( element.fSize >= 0 );
+    }
+
+    bool readElement( CReader & reader, qint64 pos, SElement & element )
+    {
+        auto header = reader.read( pos, std::min< qint64 >( 12, reader.size() - pos ) );
+        return readElement( reinterpret_cast< const uchar * >( header.constData() ), header.size(), element );
+    }
+
+    using TChildFunc = std::function< void( quint64 id, const uchar * data, qint64 size ) >;
+    void forEachChild( const uchar * data, qint64 size, const TChildFunc & func )
+    {
+        for ( qint64 pos = 0; pos < size; )
+        {
+            SElement child;
+            if ( !readElement( data + pos, size - pos, child ) || child.fUnknownSize || ( child.fSize > ( size - pos - child.fHeaderSize ) ) )
+                return;
+            func( child.fID, data + pos + child.fHeaderSize, child.fSize );
+            pos += child.fHeaderSize + child.fSize;
+        }
+    }
+
+    void parseInfo( const QByteArray & data, SMediaInfo & info )
+    {
+        quint64 timecodeScale = 1000000;
+        double duration = 0.0;
+        forEachChild( reinterpret_cast< const uchar * >( data.constData() ), data.size(), [ &timecodeScale, &duration ]( quint64 id, const uchar * data, qint64 size )
+            {
+                if ( id == kTimecodeScale )
+                    timecodeScale = readUInt( data, size );
+                else if ( ( id == kDuration ) && ( size == 4 ) )
+                {
+                    auto bits = static_cast< quint32 >( readUInt( data, size ) );
+                    float value;
+                    std::memcpy( &value, &bits, sizeof( value ) );
+                    duration = value;
+                }
+                else if ( ( id == kDuration ) && ( size == 8 ) )
+                {
+                    auto bits = readUInt( data, size );
+                    double value;
+                    std::memcpy( &value, &bits, sizeof( value ) );
+                    duration = value;
+                }
+            } );
+        info.fDuration = duration * timecodeScale / 1e9;
+    }
+
+    void parseTracks( const QByteArray & data, SMediaInfo & info )
+    {
+        forEachChild( reinterpret_cast< const uchar * >( data.constData() ), data.size(), [ &info ]( quint64 id, const uchar * data, qint64 size )
+            {
+                if ( id != kTrackEntry )
+                    return;
+
+                quint64 trackType = 0;
+                QString codec;
+                int width = 0;
+                int height = 0;
+                int channels = 1; // the spec's default
+                forEachChild( data, size, [ & ]( quint64 id, const uchar * data, qint64 size )
+                    {
+                        if ( id == kTrackType )
+                            trackType = readUInt( data, size );
+                        else if ( id == kCodecID )
+                            codec = QString::fromLatin1( reinterpret_cast< const char * >( data ), static_cast< int >( size ) ).trimmed();
+                        else if ( id == kVideo )
+                        {
+                            forEachChild( data, size, [ &width, &height ]( quint64 id, const uchar * data, qint64 size )
+                                {
+                                    if ( id == kPixelWidth )
+                                        width = static_cast< int >( readUInt( data, size ) );
+                                    else if ( id == kPixelHeight )
+                                        height = static_cast< int >( readUInt( data, size ) );
+                                } );
+                        }
+                        else if ( id == kAudio )
+                        {
+                            forEachChild( data, size, [ &channels ]( quint64 id, const uchar * data, qint64 size )
+                                {
+                                    if ( id == kChannels )
+                                        channels = static_cast< int >( readUInt( data, size ) );
+                                } );
+                        }
+                    } );
+
+                // the first track of each kind is the default one
+                if ( ( trackType == 1 ) && info.fVideoCodec.isEmpty() )
+                {
+                    info.fVideoCodec = normalizeCodec( codec );
+                    info.fWidth = width;
+                    info.fHeight = height;
+                }
+                else if ( ( trackType == 2 ) && info.fAudioCodec.isEmpty() )
+                {
+                    info.fAudioCodec = normalizeCodec( codec );
+                    info.fAudioChannels = channels;
+                }
+            } );
+    }
+
+    void parseSeekHead( const QByteArray & data, qint64 segmentStart, qint64 & infoPos, qint64 & tracksPos )
+    {
+        forEachChild( reinterpret_cast< const uchar * >( data.constData() ), data.size(), [ segmentStart, &infoPos, &tracksPos ]( quint64 id, const uchar * data, qint64 size )
+            {
+                if ( id != kSeek )
+                    return;
+
+                quint64 seekID = 0;
+                qint64 seekPos = -1;
+                forEachChild( data, size, [ &seekID, &seekPos ]( quint64 id, const uchar * data, qint64 size )
+                    {
+                        if ( id == kSeekID )
+                            seekID = readUInt( data, size );
+                        else if ( id == kSeekPosition )
+                            seekPos = static_cast< qint64 >( readUInt( data, size ) );
+                    } );
+                if ( seekPos < 0 )
+                    return;
+                if ( seekID == kInfo )
+                    infoPos = segmentStart + seekPos;
+                else if ( seekID == kTracks )
+                    tracksPos = segmentStart + seekPos;
+            } );
+    }
+
+    bool probeMKV( CReader & reader, SMediaInfo & info )
+    {
+        SElement element;
+        if ( !readElement( reader, 0, element ) || ( element.fID != kEBMLHeader ) || element.fUnknownSize )
+        {
+            info.fError = "Not an EBML file";
+            return false;
+        }
+
+        qint64 pos = element.fHeaderSize + element.fSize;
+        if ( !readElement( reader, pos, element ) || ( element.fID != kSegment ) )
+        {
+            info.fError = "No segment found";
+            return false;
+        }
+        auto segmentStart = pos + element.fHeaderSize;
+        auto segmentEnd = element.fUnknownSize ? reader.size() : std::min( reader.size(), segmentStart + element.fSize );
+
+        // the top level elements are walked header by header, the clusters are never read
+        qint64 infoPos = -1;
+        qint64 tracksPos = -1;
+        bool haveInfo = false;
+        bool haveTracks = false;
+        for ( pos = segmentStart; ( pos < segmentEnd ) && !( haveInfo && haveTracks ); )
+        {
+            if ( !readElement( reader, pos, element ) || element.fUnknownSize )
+                break;
+
+            auto dataPos = pos + element.fHeaderSize;
+            if ( element.fID == kInfo )
+            {
+                parseInfo( reader.read( dataPos, element.fSize ), info );
+                haveInfo = true;
+            }
+            else if ( element.fID == kTracks )
+            {
+                parseTracks( reader.read( dataPos, element.fSize ), info );
+                haveTracks = true;
+            }
+            else if ( element.fID == kSeekHead )
+                parseSeekHead( reader.read( dataPos, element.fSize ), segmentStart, infoPos, tracksPos );
+            else if ( element.fID == kCluster )
+                break; // anything else is found through the seek head
+            pos = dataPos + element.fSize;
+        }
+
+        if ( !haveInfo && ( infoPos >= 0 ) && readElement( reader, infoPos, element ) && ( element.fID == kInfo ) )
+        {
+            parseInfo( reader.read( infoPos + element.fHeaderSize, element.fSize ), info );
+            haveInfo = true;
+        }
+        if ( !haveTracks && ( tracksPos >= 0 ) && readElement( reader, tracksPos, element ) && ( element.fID == kTracks ) )
+        {
+            parseTracks( reader.read( tracksPos + element.fHeaderSize, element.fSize ), info );
+            haveTracks = true;
+        }
+
+        if ( !haveTracks )
+        {
+            info.fError = "No tracks found";
+            return false;
+        }
+        return true;
+    }
+
+    // MP4
+
+    struct SBox
+    {
+        QByteArray fType;
+        qint64 fDataPos{ 0 };
+        qint64 fEnd{ 0 };
+    };
+
+    using TBoxFunc = std::function< void( const SBox & box ) >;
+    void forEachBox( CReader & reader, qint64 pos, qint64 end, const TBoxFunc & func )
+    {
+        while ( ( pos + 8 ) <= end )
+        {
+            auto header = reader.read( pos, 16 );
+            if ( header.size() < 8 )
+                return;
+
+            auto data = reinterpret_cast< const uchar * >( header.constData() );
+            SBox box;
+            box.fType = header.mid( 4, 4 );
+            auto size = static_cast< qint64 >( readUInt( data, 4 ) );
+            box.fDataPos = pos + 8;
+            if ( size == 1 ) // 64 bit size follows the type
+            {
+                if ( header.size() < 16 )
+                    return;
+                size = static_cast< qint64 >( readUInt( data + 8, 8 ) );
+                box.fDataPos += 8;
+            }
+            else if ( size == 0 ) // to the end of the file
+                size = end - pos;
+            if ( ( size < ( box.fDataPos - pos ) ) || ( ( pos + size ) > end ) )
+                return;
+            box.fEnd = pos + size;
+            func( box );
+            pos = box.fEnd;
+        }
+    }
+
+    bool probeMP4( CReader & reader, SMediaInfo & info )
+    {
+        bool haveMoov = false;
+        forEachBox( reader, 0, reader.size(), [ & ]( const SBox & box )
+            {
+                if ( haveMoov || ( box.fType != "moov" ) )
+                    return; // mdat is skipped over by its size
+                haveMoov = true;
+
+                forEachBox( reader, box.fDataPos, box.fEnd, [ & ]( const SBox & box )
+                    {
+                        if ( box.fType == "mvhd" )
+                        {
+                            auto data = reader.read( box.fDataPos, 32 );
+                            auto bytes = reinterpret_cast< const uchar * >( data.constData() );
+                            if ( ( data.size() >= 20 ) && ( bytes[ 0 ] == 0 ) )
+                                info.fDuration = static_cast< double >( readUInt( bytes + 16, 4 ) ) / std::max< quint64 >( 1, readUInt( bytes + 12, 4 ) );
+                            else if ( data.size() >= 32 )
+                                info.fDuration = static_cast< double >( readUInt( bytes + 24, 8 ) ) / std::max< quint64 >( 1, readUInt( bytes + 20, 4 ) );
+                        }
+                        else if ( box.fType == "trak" )
+                        {
+                            QByteArray handler;
+                            QByteArray sampleEntry;
+                            std::function< void( const SBox & ) > findBoxes = [ & ]( const SBox & box )
+                            {
+                                if ( ( box.fType == "mdia" ) || ( box.fType == "minf" ) || ( box.fType == "stbl" ) )
+                                    forEachBox( reader, box.fDataPos, box.fEnd, findBoxes );
+                                else if ( box.fType == "hdlr" )
+                                    handler = reader.read( box.fDataPos + 8, 4 );
+                                else if ( box.fType == "stsd" )
+                                    sampleEntry = reader.read( box.fDataPos + 8, 36 ); // the first entry only
+                            };
+                            forEachBox( reader, box.fDataPos, box.fEnd, findBoxes );
+                            if ( sampleEntry.size() < 8 )
+                                return;
+
+                            auto bytes = reinterpret_cast< const uchar * >( sampleEntry.constData() );
+                            auto codec = QString::fromLatin1( sampleEntry.mid( 4, 4 ) );
+                            if ( ( handler == "vide" ) && info.fVideoCodec.isEmpty() && ( sampleEntry.size() >= 36 ) )
+                            {
+                                info.fVideoCodec = normalizeCodec( codec );
+                                info.fWidth = static_cast< int >( readUInt( bytes + 32, 2 ) );
+                                info.fHeight = static_cast< int >( readUInt( bytes + 34, 2 ) );
+                            }
+                            else if ( ( handler == "soun" ) && info.fAudioCodec.isEmpty() && ( sampleEntry.size() >= 26 ) )
+                            {
+                                info.fAudioCodec = normalizeCodec( codec );
+                                info.fAudioChannels = static_cast< int >( readUInt( bytes + 24, 2 ) );
+                            }
+                        }
+                    } );
+            } );
+
+        if ( !haveMoov )
+        {
+            info.fError = "No moov box found";
+            return false;
+        }
+        return true;
+    }
+}
+
+QString SMediaInfo::resolution() const
+{
+    if ( !fWidth || !fHeight )
+        return QString();
+    return QString( "%1x%2" ).arg( fWidth ).arg( fHeight );
+}
+
+SMediaInfo CMediaProbe::probe( const QString & path )
+{
+    TRACE_SCOPE( "probe", "CMediaProbe::probe" );
+    SMediaInfo retVal;
+    QFile fi( path );
+    if ( !fi.open( QFile::ReadOnly ) )
+    {
+        retVal.fError = QString( "Could not open file '%1'" ).arg( path );
+        return retVal;
+    }
+    retVal.fSize = fi.size();
+
+    CReader reader( fi, retVal );
+    auto suffix = QFileInfo( path ).suffix().toLower();
+    if ( ( suffix == "mp4" ) || ( suffix == "m4v" ) || ( suffix == "mov" ) )
+        retVal.fValid = probeMP4( reader, retVal );
+    else
+        retVal.fValid = probeMKV( reader, retVal );
+
+    if ( retVal.fValid && ( retVal.fDuration > 0 ) )
+        retVal.fBitrate = static_cast< qint64 >( retVal.fSize * 8 / retVal.fDuration );
+    return retVal;
+}
+
+int CMediaProbe::codecTier( const QString & codec )
+{
+    if ( ( codec == "AV1" ) || ( codec == "HEVC" ) )
+        return 3;
+    if ( codec == "VP9" )
+        return 2;
+    if ( codec == "AVC" )
+        return 1;
+    return 0;
+}
+
+bool CMediaProbe::isBetter( const SMediaInfo & lhs, const SMediaInfo & rhs )
+{
+    if ( lhs.fValid != rhs.fValid )
+        return lhs.fValid;
+
+    auto lhsPixels = static_cast< qint64 >( lhs.fWidth ) * lhs.fHeight;
+    auto rhsPixels = static_cast< qint64 >( rhs.fWidth ) * rhs.fHeight;
+    if ( lhsPixels != rhsPixels )
+        return lhsPixels > rhsPixels;
+
+    auto lhsTier = codecTier( lhs.fVideoCodec );
+    auto rhsTier = codecTier( rhs.fVideoCodec );
+    if ( lhsTier != rhsTier )
+        return lhsTier > rhsTier;
+
+    if ( lhs.fBitrate != rhs.fBitrate )
+        return lhs.fBitrate > rhs.fBitrate;
+    return lhs.fSize > rhs.fSize;
+}
+
+std::vector< size_t > CMediaProbe::rank( const std::vector< SMediaInfo > & infos )
+{
+    std::vector< size_t > retVal( infos.size() );
+    for ( size_t ii = 0; ii < retVal.size(); ++ii )
+        retVal[ ii ] = ii;
+    std::stable_sort( retVal.begin(), retVal.end(), [ &infos ]( size_t lhs, size_t rhs ) { return isBetter( infos[ lhs ], infos[ rhs ] ); } );
+    return retVal;
+}
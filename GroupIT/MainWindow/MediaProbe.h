@@ -0,0 +1,60 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _MEDIAPROBE_H
+#define _MEDIAPROBE_H
+
+#include <QString>
+#include <vector>
+
+struct SMediaInfo
+{
+    bool fValid{ false };
+    QString fError;
+    qint64 fSize{ 0 };
+    double fDuration{ 0.0 }; // seconds
+    int fWidth{ 0 };
+    int fHeight{ 0 };
+    QString fVideoCodec; // normalized, "HEVC", "AVC" etc
+    QString fAudioCodec;
+    int fAudioChannels{ 0 };
+    qint64 fBitrate{ 0 }; // overall, bits per second
+    qint64 fBytesRead{ 0 };
+
+    QString resolution() const;
+};
+
+// Reads the container level facts of an MKV or MP4 from its headers only, the EBML Info and Tracks
+// elements or the MP4 moov box.  Clusters and mdat are seeked over, never read
+class CMediaProbe
+{
+public:
+    static SMediaInfo probe( const QString & path );
+
+    // the order the versions should be kept in, best first: resolution, then codec, then bitrate, unreadable files last
+    static std::vector< size_t > rank( const std::vector< SMediaInfo > & infos );
+    static bool isBetter( const SMediaInfo & lhs, const SMediaInfo & rhs );
+    static int codecTier( const QString & codec );
+};
+
+#endif
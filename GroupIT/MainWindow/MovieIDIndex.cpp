@@ -0,0 +1,168 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "MovieIDIndex.h"
+#include "Common/Trace.h"
+#include "Common/ScanStats.h"
+#include "Common/DirWalker.h"
+
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <deque>
+#include <iterator>
+
+bool CMovieIDIndex::skipDir( const QString & path )
+{
+    if ( path.contains( "Featurettes" ) )
+        return true;
+    if ( path.contains( "SRT" ) )
+        return true;
+    if ( path.contains( "Artwork" ) )
+        return true;
+    if ( path.contains( "Extras" ) )
+        return true;
+    if ( path.contains( "eaDir" ) )
+        return true;
+    if ( path.contains( "Subs" ) )
+        return true;
+    if ( path.contains( "subs" ) )
+        return true;
+    return false;
+}
+
+bool CMovieIDIndex::splitVersionName( const QString & dirLeafName, QString & baseName, QString & extraInfo, bool & outOfOrder )
+{
+    static thread_local QRegularExpression sRegExp( "(?<name>.*)\\s\\(.*\\)\\s*-\\s*(?<extraInfo>.*)\\s*\\[(tmdbid|imdbid)\\=\\s*(?<id>.*)\\s*\\]" );
+    static thread_local QRegularExpression sOutOfOrderRegExp( "(?<name>.*)\\s\\(.*\\)\\s*\\[(tmdbid|imdbid)\\=\\s*(?<id>.*)\\s*\\]\\s*-\\s*(?<extraInfo>.*)" );
+
+    outOfOrder = false;
+    NScanStats::add( NScanStats::eRegexEvals );
+    auto match = sRegExp.match( dirLeafName );
+    if ( !match.hasMatch() )
+    {
+        NScanStats::add( NScanStats::eRegexEvals );
+        match = sOutOfOrderRegExp.match( dirLeafName );
+        if ( !match.hasMatch() )
+            return false;
+        outOfOrder = true;
+    }
+    baseName = match.captured( "name" ).trimmed();
+    extraInfo = match.captured( "extraInfo" ).trimmed();
+    return true;
+}
+
+bool CMovieIDIndex::isBadFileName( const QString & dirLeafName, const QString & filePath )
+{
+    QString baseName;
+    QString extraInfo;
+    bool outOfOrder;
+    if ( !splitVersionName( dirLeafName, baseName, extraInfo, outOfOrder ) )
+        return false; // the base version can be named anything
+
+    auto fileName = QFileInfo( filePath ).baseName();
+    return outOfOrder || ( ( fileName != QString( "%1-%2" ).arg( baseName ).arg( extraInfo ) ) && ( fileName != QString( "%1 - %2" ).arg( baseName ).arg( extraInfo ) ) );
+}
+
+void CMovieIDIndex::merge( CMovieIDIndex && other )
+{
+    for ( auto && ii : other.fGroups )
+    {
+        auto && group = fGroups[ ii.first ];
+        if ( group.fFolders.empty() )
+            group.fName = ii.second.fName;
+        std::move( ii.second.fFolders.begin(), ii.second.fFolders.end(), std::back_inserter( group.fFolders ) );
+    }
+    other.fGroups.clear();
+}
+
+SIDGroup & CMovieIDIndex::add( SFoundFolder && folder )
+{
+    auto && group = fGroups[ folder.fID ];
+    if ( group.fFolders.empty() )
+        group.fName = folder.fName;
+    group.fFolders.push_back( std::move( folder.fFolder ) );
+    return group;
+}
+
+bool CMovieIDIndex::scan( const QString & rootDir, const TProgressFunc & progressFunc, const TFolderFunc & folderFunc )
+{
+    TRACE_SCOPE( "scan", "CMovieIDIndex::scan" );
+    SCAN_PHASE( "walk" );
+    static thread_local QRegularExpression sIDRegExp( "(?<name>.*)\\s\\(.*\\[(tmdbid|imdbid)\\=\\s*(?<id>.*)\\s*\\]" );
+
+    std::deque< QString > pending;
+    pending.push_back( QFileInfo( rootDir ).absoluteFilePath() );
+    bool isRoot = true;
+    int cnt = 0;
+    std::vector< NDirWalker::SEntry > entries;
+    while ( !pending.empty() )
+    {
+        auto dirPath = std::move( pending.front() );
+        pending.pop_front();
+
+        // the root is never a movie folder, the skipped directories aren't either but they are still walked
+        SFoundFolder found;
+        auto dirLeafName = QFileInfo( dirPath ).fileName();
+        if ( !isRoot && !skipDir( dirLeafName ) )
+        {
+            NScanStats::add( NScanStats::eRegexEvals );
+            auto match = sIDRegExp.match( dirLeafName );
+            if ( match.hasMatch() )
+            {
+                found.fID = match.captured( "id" );
+                found.fName = match.captured( "name" );
+                found.fFolder.fPath = dirPath;
+            }
+        }
+        isRoot = false;
+
+        // the listing says which entries are directories, nothing is stat'ed
+        NDirWalker::readDir( dirPath, entries );
+        for ( auto && ii : entries )
+        {
+            if ( ( ( ++cnt % 100 ) == 0 ) && progressFunc && !progressFunc( cnt ) )
+                return false;
+
+            if ( ii.fIsDir )
+            {
+                pending.push_back( NDirWalker::filePath( dirPath, ii ) );
+                continue;
+            }
+            if ( !ii.fIsFile || found.fFolder.fPath.isEmpty() || !ii.fName.endsWith( ".mkv", Qt::CaseInsensitive ) || skipDir( ii.fName ) )
+                continue;
+
+            SMovieFile file;
+            file.fPath = NDirWalker::filePath( dirPath, ii );
+            file.fBadFileName = isBadFileName( dirLeafName, file.fPath );
+            found.fFolder.fFiles.push_back( file );
+        }
+
+        if ( found.fFolder.fPath.isEmpty() )
+            continue;
+        if ( folderFunc )
+            folderFunc( std::move( found ) );
+        else
+            add( std::move( found ) );
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _MOVIEIDINDEX_H
+#define _MOVIEIDINDEX_H
+
+#include <QString>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+struct SMovieFile
+{
+    QString fPath; // absolute
+    bool fBadFileName{ false }; // doesn't match the "Name - Extra Info" of its folder
+};
+
+struct SMovieFolder
+{
+    QString fPath; // absolute
+    std::vector< SMovieFile > fFiles;
+};
+
+// a folder as the scan reports it, before it is grouped
+struct SFoundFolder
+{
+    QString fID;
+    QString fName;
+    SMovieFolder fFolder;
+};
+
+struct SIDGroup
+{
+    QString fName;
+    std::vector< SMovieFolder > fFolders;
+};
+
+// The [tmdbid=...]/[imdbid=...] folders found in a single walk, grouped by ID as plain data.  The file
+// names are validated as they are found, so nothing has to be revisited before the groups are shown
+//
+// The walk is breadth first and a folder's movies are its own files, so each folder is complete as soon as
+// its directory has been read and the ones nearest the root come first
+class CMovieIDIndex
+{
+public:
+    // called every so often with the number of entries seen, returning false cancels the scan
+    using TProgressFunc = std::function< bool( int count ) >;
+    // when given, each folder is handed over as soon as it is complete instead of being kept in the index
+    using TFolderFunc = std::function< void( SFoundFolder && folder ) >;
+
+    bool scan( const QString & rootDir, const TProgressFunc & progressFunc = {}, const TFolderFunc & folderFunc = {} );
+    SIDGroup & add( SFoundFolder && folder );
+    // folders from other roots scanned separately, appended to the groups sharing their ID
+    void merge( CMovieIDIndex && other );
+
+    const std::unordered_map< QString, SIDGroup > & groups() const { return fGroups; }
+
+    static bool skipDir( const QString & path );
+    // "Name (Year) - Extra Info [tmdbid=...]" or "Name (Year) [tmdbid=...] - Extra Info", false for the base version
+    static bool splitVersionName( const QString & dirLeafName, QString & baseName, QString & extraInfo, bool & outOfOrder );
+    static bool isBadFileName( const QString & dirLeafName, const QString & filePath );
+private:
+    std::unordered_map< QString, SIDGroup > fGroups;
+};
+
+#endif
@@ -22,6 +22,9 @@
 
 set(qtproject_SRCS
     MainWindow.cpp
+    DuplicateFinder.cpp
+    MovieIDIndex.cpp
+    MediaProbe.cpp
 )
 
 set(qtproject_H
@@ -29,6 +32,9 @@ set(qtproject_H
 )
 
 set(project_H
+    DuplicateFinder.h
+    MovieIDIndex.h
+    MediaProbe.h
 )
 
 set(qtproject_UIS
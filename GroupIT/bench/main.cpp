@@ -0,0 +1,63 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "MainWindow/MainWindow.h"
+#include "MainWindow/MovieIDIndex.h"
+#include "Common/Benchmark.h"
+
+#include <QApplication>
+
+int main( int argc, char ** argv )
+{
+    CBenchmark::setHeadless();
+    Q_INIT_RESOURCE( application );
+    QApplication appl( argc, argv );
+    appl.setApplicationName( "GroupITBench" );
+    appl.setOrganizationName( "Scott Aron Bloom" );
+    appl.setOrganizationDomain( "www.towel42.com" );
+
+    CBenchmark bench( "Times the GroupIT directory load on synthetic libraries" );
+    bench.process( appl );
+
+    CMainWindow mainWindow;
+    appl.processEvents(); // the constructor's delayed directory check
+
+    bench.addCase( "CMovieIDIndex::scan",
+        []( const QString & rootDir, QString & errorMsg )
+        {
+            CMovieIDIndex index;
+            if ( !index.scan( rootDir ) )
+            {
+                errorMsg = "Scan was canceled";
+                return false;
+            }
+            return true;
+        } );
+    bench.addCase( "CMainWindow::slotLoad",
+        [ &mainWindow ]( const QString & rootDir, QString & errorMsg )
+        {
+            if ( !CBenchmark::setDirectory( &mainWindow, "dir", rootDir, errorMsg ) )
+                return false;
+            return runUntilSignal( &mainWindow, &CMainWindow::sigLoadFinished, [ &mainWindow ]() { mainWindow.slotLoad(); }, errorMsg );
+        } );
+    return bench.run();
+}
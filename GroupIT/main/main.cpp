@@ -21,6 +21,9 @@
 // SOFTWARE.
 
 #include "MainWindow/MainWindow.h"
+#include "Common/Trace.h"
+#include "Common/Log.h"
+#include "Common/ScanStats.h"
 
 #include <QApplication>
 
@@ -32,6 +35,9 @@ int main( int argc, char ** argv )
     appl.setApplicationVersion( "0.0" );
     appl.setOrganizationName( "Scott Aron Bloom" );
     appl.setOrganizationDomain( "www.towel42.com" );
+    NTrace::initFromArguments( appl );
+    NLog::initFromArguments( appl );
+    NScanStats::initFromArguments( appl );
 
     CMainWindow mainWindow;
     mainWindow.show();
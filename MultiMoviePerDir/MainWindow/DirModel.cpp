@@ -21,7 +21,10 @@
 // SOFTWARE.
 
 #include "DirModel.h"
-#include <QDebug>
+#include "Common/Trace.h"
+#include "Common/ScanStats.h"
+#include "Common/Log.h"
+#include "Common/DirWalker.h"
 #include <QUrl>
 #include <QInputDialog>
 #include <QTextStream>
@@ -31,36 +34,129 @@
 #include <QUrl>
 #include <set>
 #include <list>
+#include <map>
+#include <vector>
+#include <algorithm>
+
+static NLog::CCategory sLog( "dirmodel" );
+
+bool CDirModel::isIgnoredDirName(const QString& baseName)
+{
+    auto lower = baseName.toLower();
+    return (lower == "#recycle") || (lower == "subs");
+}
+
+bool CDirModel::hasMovieID(const QString& dirName)
+{
+    // called from the scanner and statistics threads as well
+    static thread_local QRegularExpression sTMDBRegExp("\\[tmdbid\\=\\d+\\].*$");
+    static thread_local QRegularExpression sIMDBRegExp("\\[imdbid\\=tt\\d+\\].*$");
+    NScanStats::add(NScanStats::eRegexEvals, 2);
+    return sTMDBRegExp.match(dirName).hasMatch() || sIMDBRegExp.match(dirName).hasMatch();
+}
+
 CDirModel::CDirModel(QObject* parent /*= 0*/) :
     QFileSystemModel(parent)
 {
     (void)connect(this, &CDirModel::directoryLoaded, this, &CDirModel::slotDirLoaded);
-    (void)connect(this, &CDirModel::rootPathChanged, this, [this](const QString& /*path*/) {reset();
-    });
+    (void)connect(this, &CDirModel::rootPathChanged, this, &CDirModel::slotRootPathChanged);
+}
 
-    fTimer = new QTimer(this);
-    fTimer->setInterval(2000);
-    fTimer->setSingleShot(true);
-    connect(fTimer, &QTimer::timeout, this, &CDirModel::slotDirsFinishedLoading);
+CDirModel::~CDirModel()
+{
 
 }
 
-CDirModel::~CDirModel()
+void CDirModel::slotRootPathChanged(const QString& path)
 {
+    reset();
+    if (path.isEmpty())
+        return;
 
+    // setRootPath has already called fetchMore on the root.  When the model had listed it before nothing was
+    // fetched and no directoryLoaded will come, the crawl starts from what is cached
+    fLoading = true;
+    auto fi = QFileInfo(path);
+    if (fFetchingDirs.contains(fi))
+        fPendingDirs.insert(fi);
+    else
+    {
+        crawlDir(fi, index(path));
+        // never from inside setRootPath, the caller connects to sigLoadFinished afterwards
+        QTimer::singleShot(0, this, [this]() { checkFinished(); });
+    }
+}
+
+void CDirModel::fetchMore(const QModelIndex& parent)
+{
+    // a fetch that lists nothing, because the directory is already populated, never sends directoryLoaded
+    bool willList = canFetchMore(parent);
+    QFileSystemModel::fetchMore(parent);
+    if (willList)
+        fFetchingDirs.insert(fileInfo(parent));
 }
 
 void CDirModel::slotDirLoaded(const QString& path)
 {
-    fLoadedDirs.insert(QFileInfo(path));
+    TRACE_SCOPE( "scan", "CDirModel::slotDirLoaded" );
+    auto fi = QFileInfo(path);
+    fFetchingDirs.remove(fi);
+    if (!fLoading)
+        return;
 
-    if (fTimer->isActive())
-        fTimer->stop();
-    fTimer->start();
+    fPendingDirs.remove(fi);
+    if (fLoadedDirs.contains(fi))
+        return;
+    crawlDir(fi, index(path));
+    checkFinished();
+}
+
+void CDirModel::crawlDir(const QFileInfo& fi, const QModelIndex& idx)
+{
+    fLoadedDirs.insert(fi);
+    NScanStats::add(NScanStats::eDirsRead);
+    NScanStats::add(NScanStats::eEntriesStated, QFileSystemModel::rowCount(idx));
+    fetchChildDirs(idx);
+}
+
+void CDirModel::checkFinished()
+{
+    if (!fLoading || !fPendingDirs.isEmpty())
+        return;
+    fLoading = false;
+    slotDirsFinishedLoading();
+}
+
+void CDirModel::fetchChildDirs(const QModelIndex& parentIdx)
+{
+    if (!parentIdx.isValid())
+        return;
+
+    for (int ii = 0; ii < QFileSystemModel::rowCount(parentIdx); ++ii)
+    {
+        auto childIdx = index(ii, 0, parentIdx);
+        if (!isDir(childIdx) || isIgnoredDirName(childIdx.data().toString()))
+            continue;
+
+        auto childInfo = fileInfo(childIdx);
+        if (fLoadedDirs.contains(childInfo) || fPendingDirs.contains(childInfo))
+            continue;
+
+        if (canFetchMore(childIdx))
+            fetchMore(childIdx);
+
+        // fetched now or by the view earlier, either way directoryLoaded is still on its way.
+        // Otherwise the model already has its rows and it is crawled right away
+        if (fFetchingDirs.contains(childInfo))
+            fPendingDirs.insert(childInfo);
+        else
+            crawlDir(childInfo, childIdx);
+    }
 }
 
 void CDirModel::slotDirsFinishedLoading()
 {
+    TRACE_SCOPE( "scan", "CDirModel::slotDirsFinishedLoading" );
     QSet< QFileInfo > handled;
     if (fLoadedDirs.size() == 1)
     {
@@ -74,6 +170,8 @@ void CDirModel::slotDirsFinishedLoading()
             finishedLoading(ii, handled);
         }
     }
+    // the listeners count using the filter, so it must see the changes before the signal
+    flushDataChanged();
     emit sigLoadFinished();
 }
 
@@ -89,12 +187,8 @@ void CDirModel::finishedLoading(const QFileInfo& fi, QSet< QFileInfo > & handled
     if (!lhsIdx.isValid())
         return;
 
-    auto rhsIdx = index(path, columnCount(lhsIdx.parent()) - 1);
-    if (!rhsIdx.isValid())
-        return;
+    collectDataChanged(lhsIdx);
 
-    emit dataChanged(lhsIdx, rhsIdx);
-    
     if (fi == QFileInfo(rootPath()))
         return;
 
@@ -102,6 +196,44 @@ void CDirModel::finishedLoading(const QFileInfo& fi, QSet< QFileInfo > & handled
     finishedLoading(parentDir, handled);
 }
 
+void CDirModel::collectDataChanged(const QModelIndex& idx)
+{
+    fChangedRows.insert(idx.sibling(idx.row(), 0));
+}
+
+void CDirModel::flushDataChanged()
+{
+    if (fChangedRows.isEmpty())
+        return;
+
+    std::map< QModelIndex, std::vector< int > > rowsByParent;
+    for (auto&& ii : fChangedRows)
+    {
+        if (!ii.isValid())
+            continue;
+        rowsByParent[ii.parent()].push_back(ii.row());
+    }
+    fChangedRows.clear();
+
+    // one dataChanged per contiguous run of rows under each parent
+    for (auto&& ii : rowsByParent)
+    {
+        auto parent = ii.first;
+        auto&& rows = ii.second;
+        std::sort(rows.begin(), rows.end());
+        auto lastColumn = columnCount(parent) - 1;
+
+        size_t runStart = 0;
+        for (size_t jj = 1; jj <= rows.size(); ++jj)
+        {
+            if ((jj < rows.size()) && (rows[jj] == rows[jj - 1] + 1))
+                continue;
+            emit dataChanged(index(rows[runStart], 0, parent), index(rows[jj - 1], lastColumn, parent));
+            runStart = jj;
+        }
+    }
+}
+
 QVariant CDirModel::data(const QModelIndex& index, int role /*= Qt::DisplayRole */) const
 {
     if (!index.isValid())
@@ -148,20 +280,21 @@ std::tuple< QString, QString, QString, bool > CDirModel::computeTMDBInfo(const Q
         return std::make_tuple(QString(), QString(), QString(), false);
     }
 
-    if (!fileInfo.exists())
+    // one listing answers whether the directory is still there and which nfo files it has
+    std::vector< NDirWalker::SEntry > entries;
+    if (!NDirWalker::readDir(fileInfo.absoluteFilePath(), entries))
     {
         fURLCache[fileInfo.absoluteFilePath()] = std::make_tuple(QString(), QString(), QString(), false);
         return std::make_tuple(QString(), QString(), QString(), false);
     }
 
-    auto it = QDirIterator(fileInfo.absoluteFilePath(), { "*.nfo" });
     QString nfoFile;
-    while (it.hasNext())
+    for (auto&& ii : entries)
     {
-        it.next();
-        auto fi = it.fileInfo();
+        if (ii.fIsDir || !ii.fName.endsWith(".nfo", Qt::CaseInsensitive))
+            continue;
         if (nfoFile.isEmpty())
-            nfoFile = fi.absoluteFilePath();
+            nfoFile = NDirWalker::filePath(fileInfo.absoluteFilePath(), ii);
         else
         {
             fURLCache[fileInfo.absoluteFilePath()] = std::make_tuple(QString(), QString(), QString(), false);
@@ -220,20 +353,18 @@ QString getString(QXmlQuery& query, const QString& queryString, bool* aOK /*= nu
     return retVal;
 }
 
-std::tuple< QString, QString, QString, bool > CDirModel::getTMDBInfo( const QString & nfoFile ) const
+std::tuple< QString, QString, QString, bool > CDirModel::getTMDBInfo( const QString & nfoFile )
 {
-    QFileInfo fileInfo(nfoFile);
-    if (!fileInfo.exists())
-    {
-        return std::make_tuple( QString(), QString(), QString(), false );
-    }
-
+    TRACE_SCOPE( "nfo", "CDirModel::getTMDBInfo" );
+    SCAN_PHASE( "nfo" );
+    // a missing file fails to open, there's no need to stat it first
     QFile fi( nfoFile);
     QXmlQuery query;
     if (!fi.open(QFile::ReadOnly) || !query.setFocus(&fi))
     {
         return std::make_tuple(QString(), QString(), QString(), false);
     }
+    NScanStats::add(NScanStats::eNFOBytes, fi.size());
 
     bool aOK;
     auto tmdbid = getString(query, "/movie/tmdbid/string()", &aOK);
@@ -302,14 +433,128 @@ CDirFilterModel::CDirFilterModel(QObject* parent /*= nullptr */) :
 
 void CDirFilterModel::setSourceModel(QAbstractItemModel* sourceModel)
 {
+    if (fDirModel)
+        disconnect(fDirModel, nullptr, this, nullptr);
+    slotSourceReset();
+
+    fDirModel = dynamic_cast<CDirModel*>(sourceModel);
+    if (fDirModel)
+    {
+        // connected before the base class so the cache is cleared before it re-filters
+        connect(fDirModel, &QAbstractItemModel::dataChanged, this, &CDirFilterModel::slotSourceDataChanged);
+        connect(fDirModel, &QAbstractItemModel::rowsInserted, this, &CDirFilterModel::slotSourceRowsInserted);
+        connect(fDirModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, &CDirFilterModel::slotSourceRowsAboutToBeRemoved);
+        connect(fDirModel, &QAbstractItemModel::rowsRemoved, this, &CDirFilterModel::slotSourceRowsRemoved);
+        connect(fDirModel, &QAbstractItemModel::layoutChanged, this, &CDirFilterModel::slotSourceReset);
+        connect(fDirModel, &QAbstractItemModel::modelReset, this, &CDirFilterModel::slotSourceReset);
+    }
     QSortFilterProxyModel::setSourceModel(sourceModel);
 }
 
+void CDirFilterModel::slotSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight)
+{
+    auto parent = topLeft.parent();
+    invalidateRows(parent, topLeft.row(), bottomRight.row());
+    for (int ii = topLeft.row(); ii <= bottomRight.row(); ++ii)
+        fAcceptedRows.remove(fDirModel->index(ii, 0, parent).internalPointer());
+    invalidateAncestors(parent);
+}
+
+void CDirFilterModel::slotSourceRowsInserted(const QModelIndex& parent)
+{
+    // the bits are by row and the rows after the insert have shifted, the siblings' own entries are keyed by node and stay put
+    if (parent.isValid())
+        fAcceptedRows.remove(parent.internalPointer());
+    else
+        fRootAcceptedRows = SAcceptedRows();
+    invalidateAncestors(parent);
+}
+
+void CDirFilterModel::slotSourceRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last)
+{
+    // the removed nodes are deleted, and a new node could be given the same address
+    for (int ii = first; ii <= last; ++ii)
+        removeSubtree(fDirModel->index(ii, 0, parent));
+}
+
+void CDirFilterModel::slotSourceRowsRemoved(const QModelIndex& parent)
+{
+    slotSourceRowsInserted(parent);
+}
+
+void CDirFilterModel::removeSubtree(const QModelIndex& srcIdx)
+{
+    if (!srcIdx.isValid() || fAcceptedRows.isEmpty())
+        return;
+    fAcceptedRows.remove(srcIdx.internalPointer());
+    // only what the model has already listed, nothing is fetched
+    for (int ii = 0; ii < fDirModel->QFileSystemModel::rowCount(srcIdx); ++ii)
+        removeSubtree(fDirModel->index(ii, 0, srcIdx));
+}
+
+void CDirFilterModel::slotSourceReset()
+{
+    fAcceptedRows.clear();
+    fRootAcceptedRows = SAcceptedRows();
+}
+
+CDirFilterModel::SAcceptedRows* CDirFilterModel::findAcceptedRows(const QModelIndex& srcParent) const
+{
+    if (!srcParent.isValid())
+        return &fRootAcceptedRows;
+    auto pos = fAcceptedRows.find(srcParent.internalPointer());
+    if (pos == fAcceptedRows.end())
+        return nullptr;
+    return &(*pos);
+}
+
+void CDirFilterModel::invalidateRows(const QModelIndex& srcParent, int first, int last)
+{
+    auto rows = findAcceptedRows(srcParent);
+    if (!rows)
+        return;
+    last = std::min(last, rows->fKnown.size() - 1);
+    if (first <= last)
+        rows->fKnown.fill(false, first, last + 1);
+}
+
+void CDirFilterModel::invalidateAncestors(const QModelIndex& srcIdx)
+{
+    for (auto curr = srcIdx; curr.isValid(); curr = curr.parent())
+        invalidateRows(curr.parent(), curr.row(), curr.row());
+}
+
+bool CDirFilterModel::isAccepted(const QModelIndex& srcIdx, int depth) const
+{
+    auto parent = srcIdx.parent();
+    auto row = srcIdx.row();
+    auto rows = findAcceptedRows(parent);
+    if (rows && (row < rows->fKnown.size()) && rows->fKnown.testBit(row))
+        return rows->fAccepted.testBit(row);
+
+    auto accepted = fDirModel->acceptRow(srcIdx, depth, [this](const QModelIndex& childIdx, int childDepth) { return isAccepted(childIdx, childDepth); });
+    // until the crawl finishes acceptRow accepts everything, an answer that must not outlive it
+    if (!fDirModel->finishedLoading())
+        return accepted;
+
+    // the recursion may have rehashed the cache, so look it up again
+    auto&& newRows = parent.isValid() ? fAcceptedRows[parent.internalPointer()] : fRootAcceptedRows;
+    if (row >= newRows.fKnown.size())
+    {
+        auto size = std::max(row + 1, fDirModel->rowCount(parent));
+        newRows.fKnown.resize(size);
+        newRows.fAccepted.resize(size);
+    }
+    newRows.fKnown.setBit(row);
+    newRows.fAccepted.setBit(row, accepted);
+    return accepted;
+}
+
 int CDirModel::computeDepth( const QModelIndex & idx ) const
 {
     if ( !idx.isValid() )
         return 0;
-    qDebug().nospace().noquote() << "Computing Depth for " << idx.data();
+    LOG_TRACE( sLog, "Computing Depth for %1", idx.data() );
     if (idx == rootIndex())
         return 0;
     auto parent = idx.parent();
@@ -323,21 +568,18 @@ QString indent( int depth )
 
 bool CDirFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex& parent) const
 {
-    auto dirModel = dynamic_cast<CDirModel*>(this->sourceModel());
-    if (!dirModel)
+    TRACE_SCOPE( "classify", "CDirFilterModel::filterAcceptsRow" );
+    if (!fDirModel)
         return true;
-    auto srcIndex = dirModel->index(sourceRow, 0, parent);
+    auto srcIndex = fDirModel->index(sourceRow, 0, parent);
 
-    return dirModel->acceptRow(srcIndex, 0 );
+    return isAccepted(srcIndex, 0);
 }
 
-bool CDirModel::acceptRow( const QModelIndex & srcIdx, int depth) const
+bool CDirModel::acceptRow( const QModelIndex & srcIdx, int depth, const TAcceptFunc & acceptChild ) const
 {
     auto baseName = srcIdx.data().toString();
-    if (baseName.toLower() == "#recycle")
-        return false;
-
-    if (baseName.toLower() == "subs")
+    if (isIgnoredDirName(baseName))
         return false;
 
     if (!fFinishedLoading)
@@ -347,32 +589,23 @@ bool CDirModel::acceptRow( const QModelIndex & srcIdx, int depth) const
     if (isDir && canFetchMore(srcIdx))
         return true;
 
-    qDebug().nospace().noquote() << indent(depth) << "Checking to see if " << ( isDir ? "Dir" : "File" ) << srcIdx.data() << " should be shown";
+    LOG_TRACE( sLog, "%1Checking to see if %2 %3 should be shown", indent( depth ), isDir ? "Dir" : "File", srcIdx.data() );
     if (isDir)
     {
-        QRegularExpression regExp("\\[tmdbid\\=\\d+\\].*$");
-        auto match = regExp.match(baseName);
-        bool hasMatch = match.hasMatch();
-        if (hasMatch)
-            return false;
-
-        regExp = QRegularExpression("\\[imdbid\\=tt\\d+\\].*$");
-        match = regExp.match(baseName);
-        hasMatch = match.hasMatch();
-        if (hasMatch)
+        if (hasMovieID(baseName))
             return false;
         for( int ii = 0; ii < rowCount( srcIdx ); ++ii )
         {
             auto idx = index(ii, 0, srcIdx);
             if (this->isDir(idx))
             {
-                if (acceptRow(idx, depth + 1))
+                if (acceptChild ? acceptChild(idx, depth + 1) : acceptRow(idx, depth + 1))
                     return true;
             }
             else 
             {
                 auto fi = fileInfo(idx);
-                qDebug() << fi.absoluteFilePath();
+                LOG_TRACE( sLog, "Checking file %1", fi.absoluteFilePath() );
                 if (fi.suffix().toLower() == "mkv")
                     return true;
             }
@@ -392,6 +625,9 @@ bool CDirModel::acceptRow( const QModelIndex & srcIdx, int depth) const
 void CDirModel::reset()
 {
     this->fLoadedDirs.clear(); 
+    fPendingDirs.clear();
+    fChangedRows.clear();
+    fLoading = false;
     fFinishedLoading = false;
     fURLCache.clear();
 }
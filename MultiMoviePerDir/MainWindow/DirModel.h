@@ -29,13 +29,15 @@
 #include <set>
 #include <QSet>
 #include <tuple>
+#include <functional>
+#include <QBitArray>
+#include <QHash>
 class QMediaPlaylist;
 inline uint qHash(const QFileInfo& data, uint seed=0)
 {
     return qHash(data.absoluteFilePath().toLower(), seed);
 }
 
-class QTimer;
 class CDirModel : public QFileSystemModel
 {
     Q_OBJECT
@@ -44,6 +46,7 @@ public:
 
     void reset();
     void setPreLoaded();
+    bool finishedLoading() const { return fFinishedLoading; }
 
     ~CDirModel();
     virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
@@ -51,15 +54,22 @@ public:
     virtual Qt::ItemFlags flags(const QModelIndex& idx) const override;
     virtual int columnCount(const QModelIndex& parent) const override;
     virtual int rowCount(const QModelIndex& parent) const override;
+    virtual void fetchMore(const QModelIndex& parent) override;
 
     QModelIndex rootIndex() const;
 
     int computeDepth(const QModelIndex& idx) const;
-    bool acceptRow(const QModelIndex& srcIdex, int depth) const;
+    static bool isIgnoredDirName(const QString& baseName);
+    static bool hasMovieID(const QString& dirName);
+    static std::tuple< QString, QString, QString, bool > getTMDBInfo(const QString& nfoFile); // url, id, year, aok
+
+    using TAcceptFunc = std::function< bool( const QModelIndex & srcIdx, int depth ) >;
+    bool acceptRow(const QModelIndex& srcIdex, int depth, const TAcceptFunc & acceptChild = TAcceptFunc()) const;
 
 public Q_SLOTS:
 
 private Q_SLOTS :
+    void slotRootPathChanged(const QString& path);
     void slotDirLoaded(const QString& dir);
     void slotDirsFinishedLoading();
 
@@ -69,14 +79,22 @@ Q_SIGNALS:
     void sigLoadFinished(); 
 private:
     std::tuple< QString, QString, QString, bool > computeTMDBInfo(const QModelIndex& index) const;
-    std::tuple< QString, QString, QString, bool > getTMDBInfo(const QString& nfoFile) const;
 
     QString getTMDBURL(const QModelIndex& index, bool* aOK = nullptr) const;
     QString getTMDBID(const QModelIndex& index, bool* aOK = nullptr) const;
     QString getTMDBYear(const QModelIndex& index, bool* aOK = nullptr) const;
+    void fetchChildDirs(const QModelIndex& parentIdx);
+    void crawlDir(const QFileInfo& fi, const QModelIndex& idx);
+    void checkFinished();
+    void collectDataChanged(const QModelIndex& idx);
+    void flushDataChanged();
+
     mutable std::map< QString, std::tuple< QString, QString, QString, bool > > fURLCache; // url, id, year, aok
-    QTimer* fTimer{ nullptr };
+    QSet< QFileInfo > fFetchingDirs; // every fetchMore that started a listing, until its directoryLoaded.  Survives reset, as the model's cache does
+    QSet< QFileInfo > fPendingDirs; // the directories of this crawl in fFetchingDirs
     QSet< QFileInfo > fLoadedDirs;
+    QSet< QModelIndex > fChangedRows; // collected while the crawl finishes, merged into per-parent row ranges by flushDataChanged
+    bool fLoading{ false };
     bool fFinishedLoading{ false };
 };
 
@@ -90,8 +108,30 @@ public:
 
     virtual bool filterAcceptsRow(int sourceRow, const QModelIndex& parent) const override;
 private Q_SLOTS:
+    void slotSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+    void slotSourceRowsInserted(const QModelIndex& parent);
+    void slotSourceRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last);
+    void slotSourceRowsRemoved(const QModelIndex& parent);
+    void slotSourceReset();
 
 private:
+    struct SAcceptedRows
+    {
+        QBitArray fKnown;
+        QBitArray fAccepted;
+    };
+
+    bool isAccepted(const QModelIndex& srcIdx, int depth) const;
+    SAcceptedRows* findAcceptedRows(const QModelIndex& srcParent) const;
+    void invalidateRows(const QModelIndex& srcParent, int first, int last);
+    void invalidateAncestors(const QModelIndex& srcIdx);
+    void removeSubtree(const QModelIndex& srcIdx);
+
+    CDirModel* fDirModel{ nullptr };
+    // acceptance is cached per source parent, a dir's acceptance depends on its children so changes also clear the ancestors.
+    // Keyed by the parent's file system node, which unlike its row doesn't move when siblings are inserted or removed
+    mutable QHash< const void*, SAcceptedRows > fAcceptedRows;
+    mutable SAcceptedRows fRootAcceptedRows;
 };
 
 
@@ -22,19 +22,28 @@
 
 #include "MainWindow.h"
 #include "DirModel.h"
+#include "ScanDirModel.h"
+#include "MovieStatistics.h"
 #include "SABUtils/utils.h"
 #include "SABUtils/ScrollMessageBox.h"
 #include "SABUtils/ButtonEnabler.h"
+#include "Common/Trace.h"
+#include "Common/DirCompleter.h"
+#include "Common/Log.h"
+#include "Common/ScanStats.h"
+#include "Common/ScanStatsPanel.h"
 #include "ui_MainWindow.h"
 
 #include <QSettings>
 #include <QFileInfo>
 #include <QFileDialog>
-#include <QCompleter>
 #include <QMediaPlaylist>
 #include <QMessageBox>
 #include <QDate>
 #include <QDesktopServices> 
+#include <QElapsedTimer>
+
+static NLog::CCategory sLog( "load" );
 
 CMainWindow::CMainWindow(QWidget* parent)
     : QMainWindow(parent),
@@ -46,21 +55,22 @@ CMainWindow::CMainWindow(QWidget* parent)
     connect(fImpl->btnLoad, &QPushButton::clicked, this, &CMainWindow::slotLoad);
     connect(fImpl->btnTransform, &QPushButton::clicked, this, &CMainWindow::slotTransform);
     connect(fImpl->files, &QTreeView::doubleClicked, this, &CMainWindow::slotDoubleClicked);
+    connect(fImpl->bulkScan, &QCheckBox::toggled, fImpl->watchRoot, &QWidget::setEnabled);
 
-    auto completer = new QCompleter(this);
-    auto fsModel = new QFileSystemModel(completer);
-    fsModel->setRootPath("");
-    completer->setModel(fsModel);
-    completer->setCompletionMode(QCompleter::PopupCompletion);
-    completer->setCaseSensitivity(Qt::CaseInsensitive);
+    auto completer = new CDirCompleter(this);
+    completer->addLineEdit(fImpl->directory);
 
-    fImpl->directory->setCompleter(completer);
+    fStatsPanel = new CScanStatsPanel(this);
+    addDockWidget(Qt::BottomDockWidgetArea, fStatsPanel);
+    menuBar()->addMenu(tr("&View"))->addAction(fStatsPanel->toggleViewAction());
 
     loadSettings();
 }
 
 CMainWindow::~CMainWindow()
 {
+    if (fStatistics)
+        fStatistics->wait();
     saveSettings();
 }
 
@@ -70,6 +80,10 @@ void CMainWindow::loadSettings()
 
     fImpl->directory->setText(settings.value("Directory", QString()).toString());
     fImpl->extensions->setText(settings.value("Extensions", QString("*.mkv;*.mp4;*.avi;*.m4v")).toString());
+    fImpl->bulkScan->setChecked(settings.value("BulkScan", false).toBool());
+    fImpl->watchRoot->setChecked(settings.value("WatchRoot", false).toBool());
+    fImpl->watchRoot->setEnabled(fImpl->bulkScan->isChecked());
+    restoreState(settings.value("WindowState").toByteArray());
 
     slotDirectoryChanged();
 }
@@ -80,6 +94,9 @@ void CMainWindow::saveSettings()
 
     settings.setValue("Directory", fImpl->directory->text());
     settings.setValue("Extensions", fImpl->extensions->text());
+    settings.setValue("BulkScan", fImpl->bulkScan->isChecked());
+    settings.setValue("WatchRoot", fImpl->watchRoot->isChecked());
+    settings.setValue("WindowState", saveState());
 }
 
 void CMainWindow::slotDirectoryChanged()
@@ -102,7 +119,7 @@ void CMainWindow::slotLoad()
 
 QModelIndex CMainWindow::getIndex(const QString& dirName) const
 {
-    auto srcIdx = fDirModel->index( dirName );
+    auto srcIdx = fScanDirModel ? fScanDirModel->index( dirName ) : fDirModel->index( dirName );
     auto proxyIdx = fDirFilterModel->mapFromSource(srcIdx);
     return proxyIdx;
 }
@@ -111,6 +128,8 @@ bool CMainWindow::isDir( const QModelIndex & idx ) const
 {
     if (idx.model() == fDirModel)
         return fDirModel->isDir(idx);
+    if (idx.model() == fScanDirModel)
+        return fScanDirModel->isDir(idx);
     if ( idx.model() == fDirFilterModel )
         return isDir(fDirFilterModel->mapToSource(idx));
     return false;
@@ -120,6 +139,8 @@ QFileInfo CMainWindow::getFileInfo(const QModelIndex& idx) const
 {
     if (idx.model() == fDirModel)
         return fDirModel->fileInfo(idx);
+    if (idx.model() == fScanDirModel)
+        return fScanDirModel->fileInfo(idx);
     if (idx.model() == fDirFilterModel)
         return getFileInfo(fDirFilterModel->mapToSource(idx));
     return QFileInfo();
@@ -127,50 +148,98 @@ QFileInfo CMainWindow::getFileInfo(const QModelIndex& idx) const
 
 void CMainWindow::slotFinishedLoading()
 {
+    TRACE_SCOPE( "classify", "CMainWindow::slotFinishedLoading" );
     QApplication::restoreOverrideCursor();
-    int cnt = getFoldersRemaining( fDirFilterModel->mapFromSource( fDirModel->rootIndex() ) );
-    QMessageBox::information(this, tr("Number of Movies"), tr("There are <b>'%1'</b> movies that need tmdbid added").arg( cnt ) );
-}
+    auto rootIdx = fScanDirModel ? fScanDirModel->rootIndex() : fDirModel->rootIndex();
+    if (fScanDirModel)
+    {
+        // the bulk scan only contains the rows to be shown, so everything can be expanded at once
+        fImpl->files->setRootIndex(fDirFilterModel->mapFromSource(rootIdx));
+        fImpl->files->expandAll();
+    }
 
-int CMainWindow::getFoldersRemaining( const QModelIndex & idx ) const
-{
-    int retVal = 0;
-    if (folderHasMovie(idx))
-        retVal++;
-    for( auto ii = 0; ii < fDirFilterModel->rowCount( idx ); ++ii )
+    if (fStatistics)
     {
-        auto childIndex = fDirFilterModel->index(ii, 0, idx);
-        retVal += getFoldersRemaining(childIndex);
+        fStatistics->wait();
+        delete fStatistics;
     }
-    return retVal;
-}
 
-bool CMainWindow::folderHasMovie(const QModelIndex& idx) const
-{
-    if (!isDir(idx) && idx.isValid() )
-        return false;
-    auto srcIdx = fDirFilterModel->mapToSource(idx);
-    qDebug() << "Checking " << getFileInfo(srcIdx).absoluteFilePath() << " to see if it has a movie";
-    for (int ii = 0; ii < fDirModel->rowCount(srcIdx); ++ii)
+    QElapsedTimer timer;
+    timer.start();
+    TSnapshot snapshot;
     {
-        auto childIndex = fDirModel->index(ii, 0, srcIdx);
-        if (isDir(childIndex))
-            continue;
-        auto fileInfo = getFileInfo(childIndex);
-        if (fileInfo.suffix().toLower() == "mkv")
-            return true;
+        SCAN_PHASE( "snapshot" );
+        addToSnapshot(snapshot, rootIdx, -1);
     }
-    return false;
+
+    fStatistics = new CMovieStatistics(std::move(snapshot), timer.elapsed(), this);
+    connect(fStatistics, &QThread::finished, this, &CMainWindow::slotStatisticsFinished);
+    fStatistics->start();
+}
+
+void CMainWindow::addToSnapshot(TSnapshot& snapshot, const QModelIndex& srcIdx, int parent) const
+{
+    if (!srcIdx.isValid())
+        return;
+
+    auto isDir = this->isDir(srcIdx);
+    auto pos = static_cast<int>(snapshot.size());
+    SSnapshotEntry entry;
+    entry.fName = srcIdx.data().toString();
+    entry.fParent = parent;
+    entry.fIsDir = isDir;
+    snapshot.push_back(entry);
+    if (!isDir)
+        return;
+
+    auto srcModel = srcIdx.model();
+    for (int ii = 0; ii < srcModel->rowCount(srcIdx); ++ii)
+        addToSnapshot(snapshot, srcModel->index(ii, 0, srcIdx), pos);
+    snapshot[pos].fSubtreeEnd = static_cast<int>(snapshot.size());
+}
+
+void CMainWindow::slotStatisticsFinished()
+{
+    if (!fStatistics || (sender() != fStatistics))
+        return;
+
+    fStatsPanel->finishScan();
+    auto&& stats = fStatistics->statistics();
+    statusBar()->showMessage(tr("Counted %1 folders in %2ms (snapshot %3ms)").arg(stats.fFolders).arg(stats.fCountMS).arg(stats.fSnapshotMS));
+    auto msg = tr("There are <b>'%1'</b> movies that need tmdbid added").arg(stats.fMoviesWithoutID);
+    // the bulk scan leaves the folders that already have an id out of the tree, so there are none to count
+    if (!fScanDirModel)
+        msg += tr("<br>There are '%1' movies that already have an id").arg(stats.fMoviesWithID);
+    QMessageBox::information(this, tr("Number of Movies"), msg);
 }
 
 void CMainWindow::loadDirectory()
 {
     QApplication::setOverrideCursor(Qt::WaitCursor);
+    fStatsPanel->startScan();
     delete fDirModel;
+    fDirModel = nullptr;
+    delete fScanDirModel;
+    fScanDirModel = nullptr;
     delete fDirFilterModel;
 
-    fDirModel = new CDirModel(this);
     fDirFilterModel = new CDirFilterModel( this );
+    fImpl->files->setExpandsOnDoubleClick(false);
+    if (fImpl->bulkScan->isChecked())
+    {
+        fScanDirModel = new CScanDirModel(this);
+        fDirFilterModel->setSourceModel(fScanDirModel);
+        fImpl->files->setModel(fDirFilterModel);
+        connect(fScanDirModel, &CScanDirModel::sigLoadFinished, this, &CMainWindow::slotFinishedLoading);
+        fBtnEnabler = new NSABUtils::CButtonEnabler(fImpl->files, fImpl->btnTransform);
+
+        fScanDirModel->setNameFilters(fImpl->extensions->text().split(";"));
+        fScanDirModel->setWatchRoot(fImpl->watchRoot->isChecked());
+        fScanDirModel->setRootPath(fImpl->directory->text());
+        return;
+    }
+
+    fDirModel = new CDirModel(this);
     fDirFilterModel->setSourceModel( fDirModel );
     fImpl->files->setModel(fDirFilterModel);
     fDirModel->setReadOnly(true);
@@ -186,7 +255,6 @@ void CMainWindow::loadDirectory()
     fDirModel->setRootPath(fImpl->directory->text());
     auto rootIdx = getIndex(fImpl->directory->text());
     fImpl->files->setRootIndex( rootIdx );
-    fImpl->files->setExpandsOnDoubleClick(false);
 }
 
 QString CMainWindow::getTMDBYear(const QModelIndex& idx) const
@@ -194,12 +262,12 @@ QString CMainWindow::getTMDBYear(const QModelIndex& idx) const
     if (idx.model() == fDirFilterModel)
         return getTMDBYear(fDirFilterModel->mapToSource(idx));
 
-    if (idx.model() != fDirModel)
+    if (idx.model() != fDirFilterModel->sourceModel())
         return QString();
 
     if (idx.column() != 6)
     {
-        return getTMDBYear(fDirModel->index(idx.row(), 6, idx.parent()));
+        return getTMDBYear(idx.sibling(idx.row(), 6));
     }
 
     return idx.data().toString();
@@ -210,12 +278,12 @@ QString CMainWindow::getTMDBID(const QModelIndex& idx) const
     if (idx.model() == fDirFilterModel)
         return getTMDBID(fDirFilterModel->mapToSource(idx));
 
-    if (idx.model() != fDirModel)
+    if (idx.model() != fDirFilterModel->sourceModel())
         return QString();
 
     if (idx.column() != 5)
     {
-        return getTMDBID(fDirModel->index(idx.row(), 5, idx.parent()));
+        return getTMDBID(idx.sibling(idx.row(), 5));
     }
 
     return idx.data().toString();
@@ -226,12 +294,12 @@ QUrl CMainWindow::getTMDBUrl(const QModelIndex& idx) const
     if (idx.model() == fDirFilterModel)
         return getTMDBUrl(fDirFilterModel->mapToSource(idx));
 
-    if (idx.model() != fDirModel)
+    if (idx.model() != fDirFilterModel->sourceModel())
         return QUrl();
 
     if (idx.column() != 4)
     {
-        return getTMDBUrl(fDirModel->index(idx.row(), 4, idx.parent()));
+        return getTMDBUrl(idx.sibling(idx.row(), 4));
     }
 
     auto url = idx.data().toString();
@@ -260,7 +328,7 @@ void CMainWindow::slotDoubleClicked(const QModelIndex & idx )
 
 void CMainWindow::slotDirLoaded(const QString& dirName)
 {
-    qDebug() << "slotDirLoaded: " << dirName;
+    LOG_DEBUG( sLog, "slotDirLoaded: %1", dirName );
     auto idx = getIndex(dirName);
     if ( !idx.isValid() )
         return;
@@ -278,6 +346,7 @@ void CMainWindow::slotDirLoaded(const QString& dirName)
 
 void CMainWindow::slotTransform()
 {
+    TRACE_SCOPE( "rename", "CMainWindow::slotTransform" );
     auto selected = fImpl->files->selectionModel()->selectedIndexes();
     std::set< QString > handled;
     for (auto&& ii : selected)
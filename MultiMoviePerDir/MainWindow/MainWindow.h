@@ -27,7 +27,10 @@
 #include <QFileInfo>
 #include <QUrl>
 class CDirModel;
+class CScanDirModel;
 class CDirFilterModel;
+class CMovieStatistics;
+class CScanStatsPanel;
 class QFileInfo;
 class QDir;
 namespace NSABUtils { class CButtonEnabler; }
@@ -49,9 +52,9 @@ public Q_SLOTS:
     void slotDirLoaded(const QString& dirName);
     void slotFinishedLoading();
     void slotDoubleClicked(const QModelIndex& idx);
+    void slotStatisticsFinished();
 private:
-    int getFoldersRemaining(const QModelIndex& idx) const;
-    bool folderHasMovie(const QModelIndex& idx) const;
+    void addToSnapshot(TSnapshot& snapshot, const QModelIndex& srcIdx, int parent) const;
     void transformFile(const QFileInfo& fileInfo, TTransformation& transformations) const;
     QModelIndex getIndex(const QString& dirName) const;
     bool isDir(const QModelIndex& idx) const;
@@ -64,7 +67,10 @@ private:
     void loadDirectory();
 
     CDirModel* fDirModel{ nullptr };
+    CScanDirModel* fScanDirModel{ nullptr };
     CDirFilterModel* fDirFilterModel{ nullptr };
+    CMovieStatistics* fStatistics{ nullptr };
+    CScanStatsPanel* fStatsPanel{ nullptr };
     NSABUtils::CButtonEnabler* fBtnEnabler{ nullptr };
     std::unique_ptr< Ui::CMainWindow > fImpl;
 };
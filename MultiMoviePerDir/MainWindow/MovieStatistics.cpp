@@ -0,0 +1,133 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "MovieStatistics.h"
+#include "DirModel.h"
+#include "Common/Trace.h"
+#include "Common/ScanStats.h"
+
+#include <QElapsedTimer>
+#include <future>
+#include <algorithm>
+
+CMovieStatistics::CMovieStatistics(TSnapshot&& snapshot, qint64 snapshotMS, QObject* parent) :
+    QThread(parent),
+    fSnapshot(std::move(snapshot))
+{
+    fStatistics.fSnapshotMS = snapshotMS;
+}
+
+void CMovieStatistics::classify(int entry, std::vector< EState >& states, std::vector< char >& hasMovie) const
+{
+    auto&& curr = fSnapshot[entry];
+    if (!curr.fIsDir)
+    {
+        if ((curr.fParent != -1) && curr.fName.endsWith(".mkv", Qt::CaseInsensitive))
+            hasMovie[curr.fParent] = true;
+        return;
+    }
+
+    // the root is never filtered, below it a dir is hidden by an ignored ancestor and skipped by an id'ed one
+    auto parentState = (curr.fParent == -1) ? eNormal : states[curr.fParent];
+    if ((curr.fParent != -1) && ((parentState == eIgnored) || CDirModel::isIgnoredDirName(curr.fName)))
+        states[entry] = eIgnored;
+    else if ((curr.fParent != -1) && ((parentState == eHasID) || CDirModel::hasMovieID(curr.fName)))
+        states[entry] = eHasID;
+    else
+        states[entry] = eNormal;
+}
+
+void CMovieStatistics::countRange(int begin, int end, std::vector< EState >& states, std::vector< char >& hasMovie, SMovieStatistics& stats) const
+{
+    TRACE_SCOPE( "classify", "CMovieStatistics::countRange" );
+    // parents come before their children, and every file is in the same range as its parent
+    for (int ii = begin; ii < end; ++ii)
+        classify(ii, states, hasMovie);
+
+    for (int ii = begin; ii < end; ++ii)
+    {
+        if (!fSnapshot[ii].fIsDir || (states[ii] == eIgnored))
+            continue;
+        stats.fFolders++;
+        if (!hasMovie[ii])
+            continue;
+        if (states[ii] == eHasID)
+            stats.fMoviesWithID++;
+        else
+            stats.fMoviesWithoutID++;
+    }
+}
+
+void CMovieStatistics::run()
+{
+    TRACE_SCOPE( "classify", "CMovieStatistics::run" );
+    SCAN_PHASE( "count" );
+    QElapsedTimer timer;
+    timer.start();
+
+    auto size = static_cast<int>(fSnapshot.size());
+    if (size == 0)
+        return;
+
+    // each element is only written by the task owning its range, the root and its files are done here first
+    std::vector< EState > states(size, eNormal);
+    std::vector< char > hasMovie(size, false);
+
+    std::vector< std::pair< int, int > > subTrees;
+    classify(0, states, hasMovie);
+    for (int ii = 1; ii < size; )
+    {
+        if (fSnapshot[ii].fIsDir)
+        {
+            subTrees.emplace_back(ii, fSnapshot[ii].fSubtreeEnd);
+            ii = fSnapshot[ii].fSubtreeEnd;
+        }
+        else
+            classify(ii++, states, hasMovie);
+    }
+    countRange(0, 1, states, hasMovie, fStatistics);
+
+    // largest first, dealt round robin so the tasks end up roughly balanced
+    std::sort(subTrees.begin(), subTrees.end(), [](const std::pair< int, int >& lhs, const std::pair< int, int >& rhs) { return (lhs.second - lhs.first) > (rhs.second - rhs.first); });
+    auto numTasks = std::max(1, std::min(QThread::idealThreadCount(), static_cast<int>(subTrees.size())));
+    std::vector< std::future< SMovieStatistics > > tasks;
+    for (int ii = 0; ii < numTasks; ++ii)
+    {
+        tasks.push_back(std::async(std::launch::async, [this, ii, numTasks, &subTrees, &states, &hasMovie]()
+            {
+                SMovieStatistics retVal;
+                for (size_t jj = ii; jj < subTrees.size(); jj += numTasks)
+                    countRange(subTrees[jj].first, subTrees[jj].second, states, hasMovie, retVal);
+                return retVal;
+            }));
+    }
+
+    for (auto&& ii : tasks)
+    {
+        auto curr = ii.get();
+        fStatistics.fFolders += curr.fFolders;
+        fStatistics.fMoviesWithID += curr.fMoviesWithID;
+        fStatistics.fMoviesWithoutID += curr.fMoviesWithoutID;
+    }
+    fStatistics.fCountMS = timer.elapsed();
+}
@@ -0,0 +1,74 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _MOVIESTATISTICS_H
+#define _MOVIESTATISTICS_H
+
+#include <QThread>
+#include <QString>
+#include <vector>
+
+struct SSnapshotEntry
+{
+    QString fName;
+    int fParent{ -1 }; // index into the snapshot, -1 for the root
+    int fSubtreeEnd{ -1 }; // one past the last descendant, only set for directories
+    bool fIsDir{ false };
+};
+using TSnapshot = std::vector< SSnapshotEntry >; // depth first, the root is entry 0
+
+struct SMovieStatistics
+{
+    int fFolders{ 0 };
+    int fMoviesWithID{ 0 };
+    int fMoviesWithoutID{ 0 };
+    qint64 fSnapshotMS{ 0 };
+    qint64 fCountMS{ 0 };
+};
+
+// Counts the movie folders with and without a tmdbid/imdbid in their path, off the GUI thread.
+// The snapshot is flat so the top level subtrees can be counted in parallel without touching the models
+class CMovieStatistics : public QThread
+{
+public:
+    CMovieStatistics(TSnapshot&& snapshot, qint64 snapshotMS, QObject* parent);
+
+    void run() override;
+
+    const SMovieStatistics& statistics() const { return fStatistics; }
+private:
+    enum EState : char
+    {
+        eNormal,
+        eHasID,
+        eIgnored
+    };
+
+    void countRange(int begin, int end, std::vector< EState >& states, std::vector< char >& hasMovie, SMovieStatistics& stats) const;
+    void classify(int entry, std::vector< EState >& states, std::vector< char >& hasMovie) const;
+
+    TSnapshot fSnapshot;
+    SMovieStatistics fStatistics;
+};
+
+#endif
@@ -0,0 +1,292 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "ScanDirModel.h"
+#include "DirModel.h"
+#include "Common/Trace.h"
+#include "Common/ScanStats.h"
+#include "Common/DirWalker.h"
+
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QLocale>
+#include <QThread>
+#include <QColor>
+#include <list>
+#include <algorithm>
+
+struct SScanNode
+{
+    QString fPath;
+    QString fName;
+    bool fIsDir{ false };
+    qint64 fSize{ 0 };
+    QDateTime fModified;
+    std::tuple< QString, QString, QString, bool > fTMDBInfo; // url, id, year, aok
+    std::list< std::unique_ptr< SScanNode > > fChildren;
+};
+
+class CDirScanner : public QThread
+{
+public:
+    CDirScanner(const QString& rootPath, const QStringList& nameFilters, QObject* parent) :
+        QThread(parent),
+        fRootPath(rootPath),
+        fNameFilter(nameFilters)
+    {
+    }
+
+    void run() override
+    {
+        TRACE_SCOPE( "scan", "CDirScanner::run" );
+        SCAN_PHASE( "walk" );
+        auto rootInfo = QFileInfo(fRootPath);
+        auto root = std::make_unique< SScanNode >();
+        root->fPath = rootInfo.absoluteFilePath();
+        root->fName = rootInfo.fileName();
+        root->fIsDir = true;
+        root->fModified = rootInfo.lastModified();
+        root->fTMDBInfo = std::make_tuple(QString(), QString(), QString(), false);
+        fRoot = scanDir(std::move(root), true);
+    }
+
+    std::unique_ptr< SScanNode > takeResult() { return std::move(fRoot); }
+private:
+    std::unique_ptr< SScanNode > createNode(const QString& dirPath, const NDirWalker::SEntry& entry) const
+    {
+        auto retVal = std::make_unique< SScanNode >();
+        retVal->fPath = NDirWalker::filePath(dirPath, entry);
+        retVal->fName = entry.fName;
+        retVal->fIsDir = entry.fIsDir;
+        retVal->fSize = std::max(entry.fSize, qint64(0));
+        if (entry.hasStat())
+            retVal->fModified = QDateTime::fromMSecsSinceEpoch(entry.fModified);
+        retVal->fTMDBInfo = std::make_tuple(QString(), QString(), QString(), false);
+        return retVal;
+    }
+
+    bool isMovie(const NDirWalker::SEntry& entry) const
+    {
+        if (!entry.fIsFile || !entry.fName.endsWith(".mkv", Qt::CaseInsensitive))
+            return false;
+        return fNameFilter.isEmpty() || fNameFilter.match(entry.fName);
+    }
+
+    // mirrors CDirModel::acceptRow, returns nullptr for any directory that would be filtered out
+    std::unique_ptr< SScanNode > scanDir(std::unique_ptr< SScanNode > retVal, bool isRoot)
+    {
+        QStringList nfoFiles;
+
+        // the listing says what each entry is, only the rows that can be shown need their size and date
+        std::vector< NDirWalker::SEntry > entries;
+        NDirWalker::readDir(retVal->fPath, entries, [this](const NDirWalker::SEntry& entry) { return entry.fIsDir || isMovie(entry); });
+        for (auto&& ii : entries)
+        {
+            if (isInterruptionRequested())
+                return {};
+
+            if (ii.fIsDir)
+            {
+                if (CDirModel::isIgnoredDirName(ii.fName) || CDirModel::hasMovieID(ii.fName))
+                    continue;
+                auto child = scanDir(createNode(retVal->fPath, ii), false);
+                if (child)
+                    retVal->fChildren.push_back(std::move(child));
+                continue;
+            }
+
+            if (ii.fIsFile && ii.fName.endsWith(".nfo", Qt::CaseInsensitive))
+                nfoFiles << NDirWalker::filePath(retVal->fPath, ii);
+            if (!isMovie(ii))
+                continue;
+            retVal->fChildren.push_back(createNode(retVal->fPath, ii));
+        }
+
+        if (!isRoot && retVal->fChildren.empty())
+            return {};
+
+        if (nfoFiles.size() == 1)
+            retVal->fTMDBInfo = CDirModel::getTMDBInfo(nfoFiles.front());
+        return retVal;
+    }
+
+    QString fRootPath;
+    NDirWalker::CNameFilter fNameFilter;
+    std::unique_ptr< SScanNode > fRoot;
+};
+
+CScanDirModel::CScanDirModel(QObject* parent /*= nullptr*/) :
+    QStandardItemModel(parent)
+{
+}
+
+CScanDirModel::~CScanDirModel()
+{
+    stopScan();
+}
+
+void CScanDirModel::setNameFilters(const QStringList& filters)
+{
+    fNameFilters = filters;
+}
+
+void CScanDirModel::setWatchRoot(bool watchRoot)
+{
+    fWatchRoot = watchRoot;
+}
+
+void CScanDirModel::setRootPath(const QString& path)
+{
+    fRootPath = path.isEmpty() ? QString() : QFileInfo(path).absoluteFilePath();
+
+    delete fWatcher;
+    fWatcher = nullptr;
+    if (fWatchRoot && !fRootPath.isEmpty())
+    {
+        fWatcher = new QFileSystemWatcher(QStringList() << fRootPath, this);
+        connect(fWatcher, &QFileSystemWatcher::directoryChanged, this, &CScanDirModel::slotRootChanged);
+    }
+
+    startScan();
+}
+
+void CScanDirModel::slotRootChanged()
+{
+    startScan();
+}
+
+void CScanDirModel::startScan()
+{
+    stopScan();
+    if (fRootPath.isEmpty())
+        return;
+
+    fScanner = new CDirScanner(fRootPath, fNameFilters, this);
+    connect(fScanner, &QThread::finished, this, &CScanDirModel::slotScanFinished);
+    fScanner->start();
+}
+
+void CScanDirModel::stopScan()
+{
+    if (!fScanner)
+        return;
+
+    disconnect(fScanner, nullptr, this, nullptr);
+    fScanner->requestInterruption();
+    fScanner->wait();
+    delete fScanner;
+    fScanner = nullptr;
+}
+
+void CScanDirModel::slotScanFinished()
+{
+    TRACE_SCOPE( "scan", "CScanDirModel::slotScanFinished" );
+    SCAN_PHASE( "items" );
+    if (!fScanner || (sender() != fScanner))
+        return;
+
+    auto root = fScanner->takeResult();
+    fScanner->deleteLater();
+    fScanner = nullptr;
+
+    clear();
+    fItemMap.clear();
+    setHorizontalHeaderLabels(QStringList() << tr("Name") << tr("Size") << tr("Type") << tr("Date Modified") << tr("themoviedb URL") << tr("TMDBID") << tr("Release Year"));
+    if (root)
+    {
+        // build the whole tree detached, so the views see a single insert
+        auto row = createRow(root.get());
+        addItems(row.front(), root.get());
+        invisibleRootItem()->appendRow(row);
+    }
+    emit sigLoadFinished();
+}
+
+QList< QStandardItem* > CScanDirModel::createRow(const SScanNode* node) const
+{
+    NScanStats::add(NScanStats::eItemsCreated);
+    QLocale locale;
+    auto nameItem = new QStandardItem(node->fName);
+    nameItem->setData(node->fPath, ePathRole);
+    nameItem->setData(node->fIsDir, eIsDirRole);
+
+    QList< QStandardItem* > retVal;
+    retVal
+        << nameItem
+        << new QStandardItem(node->fIsDir ? QString() : locale.formattedDataSize(node->fSize))
+        << new QStandardItem(node->fIsDir ? tr("File Folder") : tr("%1 File").arg(QFileInfo(node->fName).suffix()))
+        << new QStandardItem(locale.toString(node->fModified, QLocale::ShortFormat))
+        << new QStandardItem(std::get< 0 >(node->fTMDBInfo))
+        << new QStandardItem(std::get< 1 >(node->fTMDBInfo))
+        << new QStandardItem(std::get< 2 >(node->fTMDBInfo));
+
+    for (auto&& ii : retVal)
+    {
+        ii->setEditable(false);
+        if (node->fIsDir && !std::get< 3 >(node->fTMDBInfo))
+            ii->setBackground(QColor(Qt::red));
+    }
+    return retVal;
+}
+
+void CScanDirModel::addItems(QStandardItem* parent, const SScanNode* node)
+{
+    fItemMap[node->fPath] = parent;
+    for (auto&& ii : node->fChildren)
+    {
+        auto row = createRow(ii.get());
+        parent->appendRow(row);
+        addItems(row.front(), ii.get());
+    }
+}
+
+QModelIndex CScanDirModel::rootIndex() const
+{
+    return index(fRootPath);
+}
+
+QModelIndex CScanDirModel::index(const QString& path, int column) const
+{
+    if (path.isEmpty())
+        return QModelIndex();
+
+    auto pos = fItemMap.find(QFileInfo(path).absoluteFilePath());
+    if (pos == fItemMap.end())
+        return QModelIndex();
+
+    auto idx = indexFromItem((*pos).second);
+    return idx.sibling(idx.row(), column);
+}
+
+bool CScanDirModel::isDir(const QModelIndex& idx) const
+{
+    if (!idx.isValid())
+        return false;
+    return idx.sibling(idx.row(), 0).data(eIsDirRole).toBool();
+}
+
+QFileInfo CScanDirModel::fileInfo(const QModelIndex& idx) const
+{
+    if (!idx.isValid())
+        return QFileInfo();
+    return QFileInfo(idx.sibling(idx.row(), 0).data(ePathRole).toString());
+}
@@ -0,0 +1,86 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _SCANDIRMODEL_H
+#define _SCANDIRMODEL_H
+
+#include <QStandardItemModel>
+#include <QFileInfo>
+#include <QStringList>
+#include <unordered_map>
+#include <memory>
+
+class QFileSystemWatcher;
+class CDirScanner;
+struct SScanNode;
+
+// Batch alternative to CDirModel, the whole tree is read by a single bulk scan on a worker thread
+// and only the rows CDirModel::acceptRow would show are kept.  No gatherer thread, no icon lookups
+// and at most one watcher, on the root directory
+class CScanDirModel : public QStandardItemModel
+{
+    Q_OBJECT
+public:
+    enum ERoles
+    {
+        ePathRole = Qt::UserRole + 1,
+        eIsDirRole
+    };
+
+    CScanDirModel(QObject* parent = nullptr);
+    ~CScanDirModel();
+
+    void setNameFilters(const QStringList& filters);
+    void setWatchRoot(bool watchRoot);
+
+    void setRootPath(const QString& path);
+    QString rootPath() const { return fRootPath; }
+
+    QModelIndex rootIndex() const;
+    using QStandardItemModel::index;
+    QModelIndex index(const QString& path, int column = 0) const;
+
+    bool isDir(const QModelIndex& idx) const;
+    QFileInfo fileInfo(const QModelIndex& idx) const;
+
+Q_SIGNALS:
+    void sigLoadFinished();
+
+private Q_SLOTS:
+    void slotScanFinished();
+    void slotRootChanged();
+
+private:
+    void startScan();
+    void stopScan();
+    void addItems(QStandardItem* parent, const SScanNode* node);
+    QList< QStandardItem* > createRow(const SScanNode* node) const;
+
+    CDirScanner* fScanner{ nullptr };
+    QFileSystemWatcher* fWatcher{ nullptr };
+    QStringList fNameFilters;
+    QString fRootPath;
+    bool fWatchRoot{ false };
+    std::unordered_map< QString, QStandardItem* > fItemMap;
+};
+
+#endif
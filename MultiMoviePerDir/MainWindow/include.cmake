@@ -23,14 +23,18 @@
 set(qtproject_SRCS
     MainWindow.cpp
     DirModel.cpp
+    ScanDirModel.cpp
+    MovieStatistics.cpp
 )
 
 set(qtproject_H
     MainWindow.h
     DirModel.h
+    ScanDirModel.h
 )
 
 set(project_H
+    MovieStatistics.h
 )
 
 set(qtproject_UIS
@@ -0,0 +1,62 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "MainWindow/DirModel.h"
+#include "MainWindow/ScanDirModel.h"
+#include "Common/Benchmark.h"
+
+#include <QApplication>
+
+static const QStringList kNameFilters = QStringList() << "*.mkv" << "*.mp4" << "*.avi" << "*.m4v";
+
+int main( int argc, char ** argv )
+{
+    CBenchmark::setHeadless();
+    QApplication appl( argc, argv );
+    appl.setApplicationName( "MultiMoviePerDirBench" );
+    appl.setOrganizationName( "Scott Aron Bloom" );
+    appl.setOrganizationDomain( "www.towel42.com" );
+
+    CBenchmark bench( "Times the MultiMoviePerDir models loading synthetic libraries" );
+    bench.process( appl );
+
+    // a new model each time, the file system model keeps what it has already read
+    bench.addCase( "CDirModel",
+        []( const QString & rootDir, QString & errorMsg )
+        {
+            CDirModel model;
+            model.setReadOnly( true );
+            model.setFilter( QDir::AllDirs | QDir::Files | QDir::NoDotAndDotDot );
+            model.setNameFilterDisables( false );
+            model.reset();
+            model.setNameFilters( kNameFilters );
+            return runUntilSignal( &model, &CDirModel::sigLoadFinished, [ &model, &rootDir ]() { model.setRootPath( rootDir ); }, errorMsg );
+        } );
+    bench.addCase( "CScanDirModel",
+        []( const QString & rootDir, QString & errorMsg )
+        {
+            CScanDirModel model;
+            model.setNameFilters( kNameFilters );
+            return runUntilSignal( &model, &CScanDirModel::sigLoadFinished, [ &model, &rootDir ]() { model.setRootPath( rootDir ); }, errorMsg );
+        } );
+    return bench.run();
+}
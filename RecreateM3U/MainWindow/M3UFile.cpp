@@ -0,0 +1,265 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "M3UFile.h"
+#include "M3UParser.h"
+#include "Common/Trace.h"
+#include "Common/ScanStats.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QRegularExpression>
+#include <QTextStream>
+#include <QUrl>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+void SMovieIndex::add( const QString & relPath )
+{
+    auto pos = relPath.lastIndexOf( "/" );
+    auto fileName = relPath;
+    if ( pos != -1 )
+    {
+        fileName = fileName.mid( pos + 1 );
+    }
+    auto baseName = QFileInfo( fileName ).baseName();
+
+    fRelPaths.insert( relPath );
+    // emplace keeps the first one found, same as the linear search did
+    fByFileName.emplace( fileName, relPath );
+    fByBaseName.emplace( baseName, relPath );
+
+    auto strippedName = CM3UFile::stripTrackNumber( fileName );
+    if ( !strippedName.isEmpty() )
+    {
+        fByStrippedName.emplace( strippedName, relPath );
+        fByStrippedName.emplace( QFileInfo( strippedName ).baseName(), relPath );
+    }
+}
+
+QString SMovieIndex::find( const QString & origName ) const
+{
+    auto baseName = QFileInfo( origName ).baseName();
+    for ( auto&& ii : { std::make_pair( &fByFileName, origName ), std::make_pair( &fByBaseName, baseName ), std::make_pair( &fByStrippedName, origName ), std::make_pair( &fByStrippedName, baseName ) } )
+    {
+        auto pos = ii.first->find( ii.second );
+        if ( pos != ii.first->end() )
+            return ( *pos ).second;
+    }
+    return QString();
+}
+
+CM3UFile::CM3UFile( const QString & path ) :
+    fPath( path )
+{
+}
+
+QString CM3UFile::stripTrackNumber( const QString & name )
+{
+    // called from the rewrite pool
+    static thread_local QRegularExpression sRegExp( "\\d+\\s*-\\s*(?<name>.*)" );
+    NScanStats::add( NScanStats::eRegexEvals );
+    auto match = sRegExp.match( name );
+    if ( !match.hasMatch() )
+        return QString();
+    return match.captured( "name" );
+}
+
+bool CM3UFile::read( QString & errorMsg )
+{
+    TRACE_SCOPE( "parse", "CM3UFile::read" );
+    SCAN_PHASE( "parse" );
+    SM3UEntry curr;
+    fHeader.clear();
+    fEntries.clear();
+    fTrailingDirectives.clear();
+
+    CM3UParser parser( true );
+    auto aOK = parser.parseFile( fPath,
+        [ this, &curr ]( CM3UParser::ELineType type, std::string_view line )
+        {
+            if ( type == CM3UParser::eHeader )
+            {
+                if ( fHeader.isEmpty() )
+                    fHeader = CM3UParser::toQString( line );
+            }
+            else if ( type == CM3UParser::eDirective )
+                curr.fDirectives << CM3UParser::toQString( line );
+            else if ( type == CM3UParser::eExtInf )
+            {
+                std::string_view prefix;
+                std::string_view name;
+                if ( CM3UParser::splitExtInf( line, prefix, name ) )
+                    curr.fExtInf = CM3UParser::toQString( prefix ) + CM3UParser::toQString( name );
+                else
+                    curr.fExtInf = CM3UParser::toQString( line );
+            }
+            else if ( type == CM3UParser::ePath )
+            {
+                auto name = CM3UParser::stripTrackNumber( line );
+                curr.fPath = CM3UParser::toQString( name.empty() ? line : name );
+                fEntries.push_back( std::move( curr ) );
+                curr = SM3UEntry();
+            }
+        }, errorMsg );
+    if ( !aOK )
+        return false;
+    fTrailingDirectives = curr.fDirectives; // a dangling #EXTINF is dropped
+
+    fOriginalSize = parser.size();
+    NScanStats::add( NScanStats::eM3UBytes, fOriginalSize );
+    fOriginalHash = parser.hash();
+    return true;
+}
+
+void CM3UFile::resolve( const SMovieIndex & index, const QString & rootDir )
+{
+    TRACE_SCOPE( "classify", "CM3UFile::resolve" );
+    SCAN_PHASE( "resolve" );
+    // each thread gets its own QDirs, they cache lazily and are not safe to share
+    auto dir = QDir( QFileInfo( fPath ).absolutePath() );
+    auto root = QDir( rootDir );
+    for ( auto && ii : fEntries )
+    {
+        if ( !ii.fPath.isEmpty() )
+            ii.fPath = getMoviePath( dir, ii.fPath, index, root );
+    }
+}
+
+QStringList CM3UFile::mediaPaths( const QString & rootDir ) const
+{
+    // string only, nothing here touches the disk
+    auto dirPath = QFileInfo( fPath ).absolutePath();
+    auto root = QDir( rootDir );
+    QStringList retVal;
+    for ( auto && ii : fEntries )
+        retVal << root.relativeFilePath( QDir::cleanPath( dirPath + "/" + ii.fPath ) );
+    return retVal;
+}
+
+QString CM3UFile::getMoviePath( const QDir & dir, const QString & origName, const SMovieIndex & index, const QDir & rootDir ) const
+{
+    NScanStats::add( NScanStats::eEntriesStated );
+    if ( QFileInfo( dir.absoluteFilePath( origName ) ).exists() )
+        return origName;
+
+    auto name = stripTrackNumber( origName );
+    if ( !name.isEmpty() )
+    {
+        return getMoviePath( dir, name, index, rootDir );
+    }
+
+    auto relPath = index.find( origName );
+    if ( relPath.isEmpty() )
+        return origName;
+
+    // found it
+    auto absPath = rootDir.absoluteFilePath( relPath );
+    return dir.relativeFilePath( absPath );
+}
+
+bool CM3UFile::isUnchanged( const QByteArray & contents ) const
+{
+    if ( contents.size() != fOriginalSize )
+        return false;
+    return QCryptographicHash::hash( contents, QCryptographicHash::Sha1 ) == fOriginalHash;
+}
+
+QByteArray CM3UFile::generate() const
+{
+    QByteArray retVal;
+    QTextStream ts( &retVal, QIODevice::WriteOnly );
+    ts << ( fHeader.isEmpty() ? QString( "#EXTM3U" ) : fHeader ) << "\n";
+    for( auto && ii : fEntries )
+    {
+        for ( auto && jj : ii.fDirectives )
+            ts << jj << "\n";
+        if ( !ii.fExtInf.isEmpty() && !ii.fPath.isEmpty() )
+            ts << ii.fExtInf << "\n";
+        if ( !ii.fPath.isEmpty() )
+            ts << QUrl::toPercentEncoding( ii.fPath ) << "\n";
+    }
+    for ( auto && ii : fTrailingDirectives )
+        ts << ii << "\n";
+    ts.flush();
+#ifdef Q_OS_WIN
+    retVal.replace( "\n", "\r\n" );
+#endif
+    return retVal;
+}
+
+static bool createHardLink( const QString & from, const QString & to )
+{
+#ifdef Q_OS_WIN
+    return CreateHardLinkW( reinterpret_cast< const wchar_t * >( QDir::toNativeSeparators( to ).utf16() ), reinterpret_cast< const wchar_t * >( QDir::toNativeSeparators( from ).utf16() ), nullptr ) != 0;
+#else
+    return ::link( QFile::encodeName( from ).constData(), QFile::encodeName( to ).constData() ) == 0;
+#endif
+}
+
+bool CM3UFile::backup( EBackupMode backupMode, QString & errorMsg ) const
+{
+    auto fileName = QFileInfo( fPath ).absoluteFilePath() + ".bak";
+    QFile::remove( fileName );
+    if ( ( backupMode == eHardLinkBackup ) && createHardLink( fPath, fileName ) )
+        return true;
+
+    if ( !QFile::copy( fPath, fileName ) )
+    {
+        errorMsg = QString( "Could not backup file '%1' to '%2'" ).arg( fPath ).arg( fileName );
+        return false;
+    }
+    return true;
+}
+
+bool CM3UFile::write( const QByteArray & contents, EBackupMode backupMode, QString & errorMsg ) const
+{
+    QSaveFile outFile( fPath );
+    if ( !outFile.open( QFile::WriteOnly ) )
+    {
+        errorMsg = QString( "Could not create file '%1'" ).arg( fPath );
+        return false;
+    }
+    outFile.write( contents );
+
+    // the original is still in place until the commit, so the backup (a link to it when possible) keeps the old contents
+    if ( ( backupMode != eNoBackup ) && !backup( backupMode, errorMsg ) )
+    {
+        outFile.cancelWriting();
+        return false;
+    }
+
+    if ( !outFile.commit() )
+    {
+        errorMsg = QString( "Could not write file '%1': %2" ).arg( fPath ).arg( outFile.errorString() );
+        return false;
+    }
+    return true;
+}
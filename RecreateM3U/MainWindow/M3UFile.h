@@ -0,0 +1,94 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _M3UFILE_H
+#define _M3UFILE_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <unordered_map>
+#include <unordered_set>
+#include <list>
+
+class QDir;
+
+struct SMovieIndex
+{
+    // all map to the path relative to the root directory
+    std::unordered_map< QString, QString > fByFileName;
+    std::unordered_map< QString, QString > fByBaseName;
+    std::unordered_map< QString, QString > fByStrippedName; // with the "NN - " prefix removed
+    std::unordered_set< QString > fRelPaths;
+
+    void add( const QString & relPath );
+    QString find( const QString & origName ) const;
+    bool contains( const QString & relPath ) const { return fRelPaths.find( relPath ) != fRelPaths.end(); }
+};
+
+struct SM3UEntry
+{
+    QStringList fDirectives; // any other # lines before the entry, written back untouched
+    QString fExtInf;
+    QString fPath;
+};
+
+// A single playlist, none of this touches the GUI so it can be run from the rewrite pool
+class CM3UFile
+{
+public:
+    enum EBackupMode
+    {
+        eNoBackup,
+        eHardLinkBackup, // falls back to a copy when the file system can't link
+        eCopyBackup
+    };
+
+    CM3UFile( const QString & path );
+
+    const QString & path() const { return fPath; }
+
+    bool read( QString & errorMsg );
+    // each entry is first looked for relative to the playlist, then by name in the movies under the playlist's root
+    void resolve( const SMovieIndex & index, const QString & rootDir );
+    QByteArray generate() const; // exactly as it will be on disk
+    // the entries relative to the root directory, as the movie index stores them
+    QStringList mediaPaths( const QString & rootDir ) const;
+    bool isUnchanged( const QByteArray & contents ) const;
+    // the new contents go to a temporary file that replaces the playlist only once fully written
+    bool write( const QByteArray & contents, EBackupMode backupMode, QString & errorMsg ) const;
+
+    static QString stripTrackNumber( const QString & name );
+private:
+    QString getMoviePath( const QDir & dir, const QString & origName, const SMovieIndex & index, const QDir & rootDir ) const;
+    bool backup( EBackupMode backupMode, QString & errorMsg ) const;
+
+    QString fPath;
+    QString fHeader; // the original #EXTM3U line, attributes and all
+    qint64 fOriginalSize{ 0 };
+    QByteArray fOriginalHash; // so an unchanged playlist can be detected without keeping or rereading it
+    std::list< SM3UEntry > fEntries;
+    QStringList fTrailingDirectives; // after the last entry
+};
+
+#endif
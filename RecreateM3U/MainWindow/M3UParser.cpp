@@ -0,0 +1,206 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "M3UParser.h"
+
+#include <QFile>
+#include <QCryptographicHash>
+#include <cstring>
+
+namespace
+{
+    bool isSpace( char ch )
+    {
+        return ( ch == ' ' ) || ( ch == '\t' ) || ( ch == '\r' ) || ( ch == '\n' ) || ( ch == '\v' ) || ( ch == '\f' );
+    }
+
+    bool isDigit( char ch )
+    {
+        return ( ch >= '0' ) && ( ch <= '9' );
+    }
+
+    int hexValue( char ch )
+    {
+        if ( isDigit( ch ) )
+            return ch - '0';
+        if ( ( ch >= 'a' ) && ( ch <= 'f' ) )
+            return ch - 'a' + 10;
+        if ( ( ch >= 'A' ) && ( ch <= 'F' ) )
+            return ch - 'A' + 10;
+        return -1;
+    }
+
+    bool startsWith( std::string_view str, std::string_view prefix )
+    {
+        return ( str.size() >= prefix.size() ) && ( str.compare( 0, prefix.size(), prefix ) == 0 );
+    }
+
+    // matches \s*\d+\s*-\s* at pos, returns the position after it or npos
+    size_t matchTrackNumber( std::string_view str, size_t pos )
+    {
+        while ( ( pos < str.size() ) && isSpace( str[ pos ] ) )
+            pos++;
+        auto digitStart = pos;
+        while ( ( pos < str.size() ) && isDigit( str[ pos ] ) )
+            pos++;
+        if ( pos == digitStart )
+            return std::string_view::npos;
+        while ( ( pos < str.size() ) && isSpace( str[ pos ] ) )
+            pos++;
+        if ( ( pos == str.size() ) || ( str[ pos ] != '-' ) )
+            return std::string_view::npos;
+        return pos + 1;
+    }
+}
+
+CM3UParser::CM3UParser( bool computeHash ) :
+    fComputeHash( computeHash )
+{
+}
+
+std::string_view CM3UParser::trimmed( std::string_view str )
+{
+    while ( !str.empty() && isSpace( str.front() ) )
+        str.remove_prefix( 1 );
+    while ( !str.empty() && isSpace( str.back() ) )
+        str.remove_suffix( 1 );
+    return str;
+}
+
+// same as the old "\d+\s*-\s*(?<name>.*)" regex, which was not anchored
+std::string_view CM3UParser::stripTrackNumber( std::string_view name )
+{
+    for ( size_t ii = 0; ii < name.size(); ++ii )
+    {
+        if ( !isDigit( name[ ii ] ) || ( ( ii != 0 ) && isDigit( name[ ii - 1 ] ) ) )
+            continue;
+
+        auto pos = matchTrackNumber( name, ii );
+        if ( pos != std::string_view::npos )
+            return trimmed( name.substr( pos ) );
+    }
+    return {};
+}
+
+// same as the old "(?<prefix>.*,)\s*\d+\s*-\s*(?<name>.*)" regex, the greedy prefix tries the last comma first
+bool CM3UParser::splitExtInf( std::string_view line, std::string_view & prefix, std::string_view & name )
+{
+    auto comma = line.rfind( ',' );
+    while ( comma != std::string_view::npos )
+    {
+        auto pos = matchTrackNumber( line, comma + 1 );
+        if ( pos != std::string_view::npos )
+        {
+            prefix = trimmed( line.substr( 0, comma + 1 ) );
+            name = trimmed( line.substr( pos ) );
+            return true;
+        }
+        if ( comma == 0 )
+            break;
+        comma = line.rfind( ',', comma - 1 );
+    }
+    return false;
+}
+
+std::string_view CM3UParser::decode( std::string_view line )
+{
+    auto pos = line.find( '%' );
+    if ( pos == std::string_view::npos )
+        return line;
+
+    fScratch.assign( line.data(), pos );
+    for ( ; pos < line.size(); ++pos )
+    {
+        if ( ( line[ pos ] == '%' ) && ( ( pos + 2 ) < line.size() ) )
+        {
+            auto hi = hexValue( line[ pos + 1 ] );
+            auto lo = hexValue( line[ pos + 2 ] );
+            if ( ( hi != -1 ) && ( lo != -1 ) )
+            {
+                fScratch.push_back( static_cast< char >( ( hi << 4 ) | lo ) );
+                pos += 2;
+                continue;
+            }
+        }
+        fScratch.push_back( line[ pos ] );
+    }
+    return fScratch;
+}
+
+void CM3UParser::parse( std::string_view contents, const TLineFunc & func )
+{
+    if ( startsWith( contents, "\xEF\xBB\xBF" ) ) // M3U8 BOM
+        contents.remove_prefix( 3 );
+
+    while ( !contents.empty() )
+    {
+        auto eol = static_cast< const char * >( std::memchr( contents.data(), '\n', contents.size() ) );
+        auto len = eol ? static_cast< size_t >( eol - contents.data() ) : contents.size();
+        auto line = trimmed( contents.substr( 0, len ) );
+        contents.remove_prefix( eol ? len + 1 : len );
+
+        if ( line.empty() )
+            continue;
+        if ( line.front() != '#' )
+            func( ePath, decode( line ) );
+        else if ( startsWith( line, "#EXTM3U" ) ) // may carry attributes, tvg-url="..." etc
+            func( eHeader, line );
+        else if ( startsWith( line, "#EXTINF" ) )
+            func( eExtInf, decode( line ) );
+        else
+            func( eDirective, line );
+    }
+}
+
+bool CM3UParser::parseFile( const QString & path, const TLineFunc & func, QString & errorMsg )
+{
+    QFile fi( path );
+    if ( !fi.open( QFile::ReadOnly ) )
+    {
+        errorMsg = QString( "Could not open file '%1'" ).arg( path );
+        return false;
+    }
+
+    fSize = fi.size();
+    fHash.clear();
+    if ( fSize == 0 ) // can't map an empty file
+    {
+        if ( fComputeHash )
+            fHash = QCryptographicHash::hash( QByteArray(), QCryptographicHash::Sha1 );
+        return true;
+    }
+
+    auto data = fi.map( 0, fSize );
+    if ( !data )
+    {
+        errorMsg = QString( "Could not map file '%1': %2" ).arg( path ).arg( fi.errorString() );
+        return false;
+    }
+
+    auto contents = std::string_view( reinterpret_cast< const char * >( data ), static_cast< size_t >( fSize ) );
+    if ( fComputeHash )
+        fHash = QCryptographicHash::hash( QByteArray::fromRawData( contents.data(), static_cast< int >( contents.size() ) ), QCryptographicHash::Sha1 );
+    parse( contents, func );
+    fi.unmap( data );
+    return true;
+}
@@ -0,0 +1,72 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _M3UPARSER_H
+#define _M3UPARSER_H
+
+#include <QString>
+#include <QByteArray>
+#include <string_view>
+#include <string>
+#include <functional>
+
+// Parses an M3U/M3U8 playlist in place.  The file is mapped rather than read, and every line handed
+// to the callback is a view into the mapping or, when it had percent escapes, into a scratch buffer
+// reused for every line.  Nothing is allocated per line, callers only allocate what they keep
+class CM3UParser
+{
+public:
+    enum ELineType
+    {
+        eHeader,    // #EXTM3U, with any attributes, as is
+        eExtInf,    // #EXTINF:..., decoded
+        eDirective, // any other # line, as is
+        ePath       // decoded
+    };
+    using TLineFunc = std::function< void( ELineType type, std::string_view line ) >;
+
+    CM3UParser( bool computeHash = false );
+
+    bool parseFile( const QString & path, const TLineFunc & func, QString & errorMsg );
+    void parse( std::string_view contents, const TLineFunc & func );
+
+    // SHA1 of the raw file contents, only when constructed with computeHash
+    const QByteArray & hash() const { return fHash; }
+    qint64 size() const { return fSize; }
+
+    // "12 - name" -> "name", empty when there is no track number
+    static std::string_view stripTrackNumber( std::string_view name );
+    // "#EXTINF:123,12 - name" -> "#EXTINF:123," "name", false when the title has no track number
+    static bool splitExtInf( std::string_view line, std::string_view & prefix, std::string_view & name );
+    static std::string_view trimmed( std::string_view str );
+    static QString toQString( std::string_view str ) { return QString::fromUtf8( str.data(), static_cast< int >( str.size() ) ); }
+private:
+    std::string_view decode( std::string_view line );
+
+    bool fComputeHash{ false };
+    QByteArray fHash;
+    qint64 fSize{ 0 };
+    std::string fScratch;
+};
+
+#endif
@@ -0,0 +1,148 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "M3URewriter.h"
+#include "M3UFile.h"
+#include "M3UState.h"
+#include "Common/Trace.h"
+
+#include <QRunnable>
+#include <QMutexLocker>
+
+class CM3URewriteTask : public QRunnable
+{
+public:
+    CM3URewriteTask( CM3URewriter * rewriter, size_t job ) :
+        fRewriter( rewriter ),
+        fJob( job )
+    {
+    }
+
+    void run() override
+    {
+        fRewriter->rewrite( fRewriter->fJobs[ fJob ] );
+    }
+private:
+    CM3URewriter * fRewriter{ nullptr };
+    size_t fJob{ 0 };
+};
+
+CM3URewriter::CM3URewriter( const QString & rootDir, CM3UFile::EBackupMode backupMode, int maxOutstandingWrites ) :
+    fRootDir( rootDir ),
+    fBackupMode( backupMode ),
+    fWriteSlots( maxOutstandingWrites )
+{
+}
+
+CM3URewriter::~CM3URewriter()
+{
+    cancel();
+    fPool.waitForDone();
+}
+
+void CM3URewriter::setState( CM3UState * state, bool skipCurrent )
+{
+    fState = state;
+    fSkipCurrent = skipCurrent;
+}
+
+void CM3URewriter::start( std::vector< SM3UJob > && jobs )
+{
+    fJobs = std::move( jobs );
+    fCompleted = 0;
+    fUnchanged = 0;
+    fSkipped = 0;
+    fCanceled = false;
+    for ( size_t ii = 0; ii < fJobs.size(); ++ii )
+        fPool.start( new CM3URewriteTask( this, ii ) );
+}
+
+bool CM3URewriter::waitForDone( int msecs )
+{
+    return fPool.waitForDone( msecs );
+}
+
+void CM3URewriter::cancel()
+{
+    fCanceled = true;
+}
+
+QStringList CM3URewriter::errors() const
+{
+    QMutexLocker locker( &fErrorMutex );
+    return fErrors;
+}
+
+void CM3URewriter::addError( const QString & msg )
+{
+    QMutexLocker locker( &fErrorMutex );
+    fErrors << msg;
+}
+
+void CM3URewriter::rewrite( const SM3UJob & job )
+{
+    if ( !fCanceled )
+    {
+        if ( fState && fSkipCurrent && fState->isCurrent( job.fPath, *job.fIndex ) )
+            fSkipped++;
+        else
+            rewriteFile( job );
+    }
+    fCompleted++;
+}
+
+void CM3URewriter::rewriteFile( const SM3UJob & job )
+{
+    TRACE_SCOPE( "rename", "CM3URewriter::rewriteFile" );
+    CM3UFile m3u( job.fPath );
+    QString errorMsg;
+    if ( !m3u.read( errorMsg ) )
+    {
+        addError( errorMsg );
+        if ( fState )
+            fState->remove( job.fPath );
+        return;
+    }
+
+    m3u.resolve( *job.fIndex, fRootDir );
+    auto contents = m3u.generate();
+    if ( m3u.isUnchanged( contents ) )
+        fUnchanged++;
+    else
+    {
+        auto aOK = false;
+        fWriteSlots.acquire();
+        if ( !fCanceled )
+        {
+            aOK = m3u.write( contents, fBackupMode, errorMsg );
+            if ( !aOK )
+                addError( errorMsg );
+        }
+        fWriteSlots.release();
+        if ( !aOK )
+            return;
+    }
+
+    if ( fState )
+        fState->update( job.fPath, contents, m3u.mediaPaths( fRootDir ) );
+}
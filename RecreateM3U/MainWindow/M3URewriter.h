@@ -0,0 +1,85 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _M3UREWRITER_H
+#define _M3UREWRITER_H
+
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QSemaphore>
+#include <QMutex>
+#include <atomic>
+#include <vector>
+#include "M3UFile.h"
+
+class CM3UState;
+
+struct SM3UJob
+{
+    QString fPath;
+    const SMovieIndex* fIndex{ nullptr }; // owned by the caller, must outlive the rewrite
+};
+
+// Rewrites playlists in parallel, parsing and resolving run on the pool while the writes
+// are throttled to a fixed number in flight.  Failures are collected rather than reported
+class CM3URewriter
+{
+public:
+    CM3URewriter( const QString & rootDir, CM3UFile::EBackupMode backupMode, int maxOutstandingWrites = 4 );
+    ~CM3URewriter();
+
+    // when set, every playlist rewritten or verified is recorded, and with skipCurrent the ones still current are not read at all
+    void setState( CM3UState * state, bool skipCurrent );
+
+    void start( std::vector< SM3UJob > && jobs );
+    bool waitForDone( int msecs );
+    void cancel();
+
+    int numJobs() const { return static_cast< int >( fJobs.size() ); }
+    int numCompleted() const { return fCompleted; }
+    int numUnchanged() const { return fUnchanged; }
+    int numSkipped() const { return fSkipped; }
+    QStringList errors() const;
+private:
+    friend class CM3URewriteTask;
+    void rewrite( const SM3UJob & job );
+    void rewriteFile( const SM3UJob & job );
+    void addError( const QString & msg );
+
+    QString fRootDir;
+    CM3UFile::EBackupMode fBackupMode;
+    CM3UState * fState{ nullptr };
+    bool fSkipCurrent{ false };
+    std::vector< SM3UJob > fJobs;
+    QThreadPool fPool;
+    QSemaphore fWriteSlots;
+    std::atomic< int > fCompleted{ 0 };
+    std::atomic< int > fUnchanged{ 0 };
+    std::atomic< int > fSkipped{ 0 };
+    std::atomic< bool > fCanceled{ false };
+    mutable QMutex fErrorMutex;
+    QStringList fErrors;
+};
+
+#endif
@@ -0,0 +1,179 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "M3UState.h"
+#include "M3UFile.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+CM3UState::CM3UState( const QString & rootDir ) :
+    fRootDir( rootDir )
+{
+}
+
+QString CM3UState::relPath( const QString & m3uPath ) const
+{
+    return QDir( fRootDir ).relativeFilePath( m3uPath );
+}
+
+bool CM3UState::load( QString & errorMsg )
+{
+    QMutexLocker locker( &fMutex );
+    fPlaylists.clear();
+
+    QFile fi( QDir( fRootDir ).absoluteFilePath( fileName() ) );
+    if ( !fi.exists() )
+        return true;
+    if ( !fi.open( QFile::ReadOnly ) )
+    {
+        errorMsg = QString( "Could not open file '%1'" ).arg( fi.fileName() );
+        return false;
+    }
+
+    QJsonParseError error;
+    auto doc = QJsonDocument::fromJson( fi.readAll(), &error );
+    if ( doc.isNull() )
+    {
+        errorMsg = QString( "Could not read file '%1': %2" ).arg( fi.fileName() ).arg( error.errorString() );
+        return false;
+    }
+
+    auto playlists = doc.object()[ "playlists" ].toObject();
+    for ( auto ii = playlists.begin(); ii != playlists.end(); ++ii )
+    {
+        auto obj = ii.value().toObject();
+        SPlaylistState state;
+        state.fSize = static_cast< qint64 >( obj[ "size" ].toDouble() );
+        state.fModified = static_cast< qint64 >( obj[ "modified" ].toDouble() );
+        state.fHash = QByteArray::fromHex( obj[ "hash" ].toString().toLatin1() );
+        for ( auto && jj : obj[ "media" ].toArray() )
+            state.fMedia << jj.toString();
+        fPlaylists[ ii.key() ] = state;
+    }
+    return true;
+}
+
+bool CM3UState::save( QString & errorMsg ) const
+{
+    QJsonObject playlists;
+    {
+        QMutexLocker locker( &fMutex );
+        for ( auto && ii : fPlaylists )
+        {
+            QJsonObject obj;
+            obj[ "size" ] = static_cast< double >( ii.second.fSize );
+            obj[ "modified" ] = static_cast< double >( ii.second.fModified );
+            obj[ "hash" ] = QString::fromLatin1( ii.second.fHash.toHex() );
+            obj[ "media" ] = QJsonArray::fromStringList( ii.second.fMedia );
+            playlists[ ii.first ] = obj;
+        }
+    }
+
+    QJsonObject root;
+    root[ "version" ] = 1;
+    root[ "playlists" ] = playlists;
+
+    QSaveFile fi( QDir( fRootDir ).absoluteFilePath( fileName() ) );
+    if ( !fi.open( QFile::WriteOnly ) )
+    {
+        errorMsg = QString( "Could not create file '%1'" ).arg( fi.fileName() );
+        return false;
+    }
+    fi.write( QJsonDocument( root ).toJson( QJsonDocument::Compact ) );
+    if ( !fi.commit() )
+    {
+        errorMsg = QString( "Could not write file '%1': %2" ).arg( fi.fileName() ).arg( fi.errorString() );
+        return false;
+    }
+    return true;
+}
+
+bool CM3UState::isCurrent( const QString & m3uPath, const SMovieIndex & index ) const
+{
+    QFileInfo fi( m3uPath );
+    auto key = relPath( m3uPath );
+
+    QMutexLocker locker( &fMutex );
+    auto pos = fPlaylists.find( key );
+    if ( pos == fPlaylists.end() )
+        return false;
+
+    auto state = ( *pos ).second;
+    locker.unlock();
+
+    if ( state.fSize != fi.size() )
+        return false;
+    // touched, copied or restored from a backup, the contents decide
+    if ( ( state.fModified != fi.lastModified().toMSecsSinceEpoch() ) && ( hashFile( m3uPath ) != state.fHash ) )
+        return false;
+
+    // a movie outside the index, renamed or never found, could now resolve differently
+    for ( auto && ii : state.fMedia )
+    {
+        if ( !index.contains( ii ) )
+            return false;
+    }
+    return true;
+}
+
+QByteArray CM3UState::hashFile( const QString & m3uPath )
+{
+    QFile fi( m3uPath );
+    if ( !fi.open( QFile::ReadOnly ) )
+        return QByteArray();
+
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    if ( !hash.addData( &fi ) )
+        return QByteArray();
+    return hash.result();
+}
+
+void CM3UState::update( const QString & m3uPath, const QByteArray & contents, const QStringList & mediaPaths )
+{
+    QFileInfo fi( m3uPath );
+    SPlaylistState state;
+    state.fSize = fi.size();
+    state.fModified = fi.lastModified().toMSecsSinceEpoch();
+    state.fHash = QCryptographicHash::hash( contents, QCryptographicHash::Sha1 );
+    state.fMedia = mediaPaths;
+
+    auto key = relPath( m3uPath );
+    QMutexLocker locker( &fMutex );
+    fPlaylists[ key ] = state;
+}
+
+void CM3UState::remove( const QString & m3uPath )
+{
+    auto key = relPath( m3uPath );
+    QMutexLocker locker( &fMutex );
+    fPlaylists.erase( key );
+}
@@ -0,0 +1,68 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _M3USTATE_H
+#define _M3USTATE_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QMutex>
+#include <unordered_map>
+
+struct SMovieIndex;
+
+// The sidecar kept in the root directory between runs.  A playlist is current when it is the same file
+// that was last written or verified and every movie it references is still in the movie index, so it
+// can be skipped without being parsed.  The size and modification time identify the file, only when
+// just the time differs is it read and compared by hash.  Safe to query and update from the rewrite pool
+class CM3UState
+{
+public:
+    CM3UState( const QString & rootDir );
+
+    bool load( QString & errorMsg ); // a missing file is not an error, everything is simply out of date
+    bool save( QString & errorMsg ) const;
+
+    bool isCurrent( const QString & m3uPath, const SMovieIndex & index ) const;
+    void update( const QString & m3uPath, const QByteArray & contents, const QStringList & mediaPaths );
+    void remove( const QString & m3uPath );
+
+    static QString fileName() { return ".RecreateM3U.state"; }
+private:
+    struct SPlaylistState
+    {
+        qint64 fSize{ 0 };
+        qint64 fModified{ 0 };
+        QByteArray fHash; // SHA1 of the playlist as written
+        QStringList fMedia; // relative to the root directory
+    };
+    QString relPath( const QString & m3uPath ) const;
+    static QByteArray hashFile( const QString & m3uPath ); // empty when it can't be read
+
+    QString fRootDir;
+    mutable QMutex fMutex;
+    std::unordered_map< QString, SPlaylistState > fPlaylists;
+};
+
+#endif
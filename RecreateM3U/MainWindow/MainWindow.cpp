@@ -22,15 +22,21 @@
 
 #include "MainWindow.h"
 #include "DirModel.h"
+#include "M3URewriter.h"
+#include "M3UState.h"
 #include "SABUtils/utils.h"
 #include "SABUtils/ScrollMessageBox.h"
 #include "SABUtils/ButtonEnabler.h"
+#include "Common/Trace.h"
+#include "Common/DirCompleter.h"
+#include "Common/DirWalker.h"
+#include "Common/ScanStats.h"
+#include "Common/ScanStatsPanel.h"
 #include "ui_MainWindow.h"
 
 #include <QSettings>
 #include <QFileInfo>
 #include <QFileDialog>
-#include <QCompleter>
 #include <QMessageBox>
 #include <QDate>
 #include <QDesktopServices> 
@@ -38,6 +44,7 @@
 #include <QProgressDialog>
 #include <QScrollBar>
 #include <QDebug>
+#include <QStatusBar>
 
 CMainWindow::CMainWindow(QWidget* parent)
     : QMainWindow(parent),
@@ -51,14 +58,13 @@ CMainWindow::CMainWindow(QWidget* parent)
     connect(fImpl->btnSelectDir, &QPushButton::clicked, this, &CMainWindow::slotSelectDirectory);
     connect(fImpl->btnTransform, &QPushButton::clicked, this, &CMainWindow::slotTransform);
 
-    auto completer = new QCompleter(this);
-    auto fsModel = new QFileSystemModel(completer);
-    fsModel->setRootPath("");
-    completer->setModel(fsModel);
-    completer->setCompletionMode(QCompleter::PopupCompletion);
-    completer->setCaseSensitivity(Qt::CaseInsensitive);
+    auto completer = new CDirCompleter(this);
+    completer->addLineEdit(fImpl->dir);
 
-    fImpl->dir->setCompleter(completer);
+    fStatsPanel = new CScanStatsPanel(this);
+    addDockWidget(Qt::BottomDockWidgetArea, fStatsPanel);
+    menuBar()->addMenu(tr("&View"))->addAction(fStatsPanel->toggleViewAction());
+    restoreState(QSettings().value("WindowState").toByteArray());
 }
 
 CMainWindow::~CMainWindow()
@@ -71,6 +77,8 @@ void CMainWindow::loadSettings()
     QSettings settings;
 
     fImpl->dir->setText(settings.value("Directory", QString()).toString());
+    fImpl->backupMode->setCurrentIndex(settings.value("BackupMode", CM3UFile::eHardLinkBackup).toInt());
+    fImpl->onlyChanged->setChecked(settings.value("OnlyChanged", true).toBool());
 }
 
 void CMainWindow::saveSettings()
@@ -78,6 +86,9 @@ void CMainWindow::saveSettings()
     QSettings settings;
 
     settings.setValue("Directory", fImpl->dir->text());
+    settings.setValue("BackupMode", fImpl->backupMode->currentIndex());
+    settings.setValue("OnlyChanged", fImpl->onlyChanged->isChecked());
+    settings.setValue("WindowState", saveState());
 }
 
 void CMainWindow::slotDirectoryChanged()
@@ -86,6 +97,7 @@ void CMainWindow::slotDirectoryChanged()
     bool aOK = !fImpl->dir->text().isEmpty() && dir.exists() && dir.isDir();
 
     fItemMap.clear();
+    fMovieIndexes.clear();
     fImpl->directories->clear();
     fImpl->directories->setHeaderLabels( QStringList() << "Name" );
 
@@ -107,57 +119,90 @@ void CMainWindow::slotLoad()
 
 void CMainWindow::loadDirectory()
 {
+    TRACE_SCOPE( "scan", "CMainWindow::loadDirectory" );
     QApplication::setOverrideCursor(Qt::WaitCursor);
+    fStatsPanel->startScan();
 
     auto header = fImpl->directories->header();
     header->setSectionResizeMode(QHeaderView::ResizeToContents);
 
-    QProgressDialog dlg(tr("Computing Number of Directories..."), "Cancel", 0, 0, this);
+    QProgressDialog dlg(tr("Finding Playlists and Movies..."), "Cancel", 0, 0, this);
     dlg.setMinimumDuration(0);
     dlg.setValue(1);
 
-    int numDirs = getNumDirs( fImpl->dir->text(), &dlg );
-    if (dlg.wasCanceled())
-        return;
-    dlg.setLabelText(tr("Finding Directories..."));
-    dlg.setRange(0, numDirs);
-    dlg.setValue(0);
-
     auto rootDir = new QTreeWidgetItem(fImpl->directories, QStringList() << ".", eParentDir);
     rootDir->setExpanded(true);
     fItemMap["."] = rootDir;
+    NScanStats::add( NScanStats::eItemsCreated );
 
-    QDirIterator ii(fImpl->dir->text(), QStringList() << "*.m3u", QDir::Filter::AllEntries | QDir::NoDotAndDotDot | QDir::NoSymLinks, QDirIterator::IteratorFlag::Subdirectories);
-
-    auto relToDir = this->relToDir();
+    // a single walk finds both, the movies are attached to the playlists afterwards rather than rescanning each playlist's tree.
+    // The listing says which entries are directories, nothing is stat'ed
+    std::list< QFileInfo > m3uFiles;
+    std::list< QFileInfo > mkvFiles;
+    std::unordered_set< QString > playlistDirs;
 
-    int cnt = 0;
-    while (ii.hasNext())
     {
-        if (dlg.wasCanceled())
-            break;
-        ii.next();
-        if ( skipDir(ii.fileName() ) )
-            continue;
-        cnt++;
-        dlg.setValue(cnt);
-        qApp->processEvents();
-
-        auto info = ii.fileInfo();
-        auto relPath = relToDir.relativeFilePath( ii.filePath() );
-        auto parent = getParent( info );
-        Q_ASSERT( parent );
+        SCAN_PHASE( "walk" );
+        std::vector< QString > pending;
+        pending.push_back( QFileInfo( fImpl->dir->text() ).absoluteFilePath() );
+        std::vector< NDirWalker::SEntry > entries;
+        int cnt = 0;
+        while ( !pending.empty() && !dlg.wasCanceled() )
+        {
+            auto dirPath = std::move( pending.back() );
+            pending.pop_back();
+            NDirWalker::readDir( dirPath, entries );
+            for ( auto && ii : entries )
+            {
+                if ( ii.fIsDir )
+                {
+                    pending.push_back( NDirWalker::filePath( dirPath, ii ) );
+                    continue;
+                }
+                if ( !ii.fIsFile )
+                    continue;
+
+                bool isM3U = ii.fName.endsWith( ".m3u", Qt::CaseInsensitive );
+                if ( !isM3U && !ii.fName.endsWith( ".mkv", Qt::CaseInsensitive ) )
+                    continue;
+
+                if ( ( ++cnt % 100 ) == 0 )
+                {
+                    dlg.setLabelText( tr( "Finding Playlists and Movies (%1 found)..." ).arg( cnt ) );
+                    qApp->processEvents();
+                }
+
+                if ( isM3U )
+                {
+                    if ( skipDir( ii.fName ) )
+                        continue;
+                    m3uFiles.emplace_back( NDirWalker::filePath( dirPath, ii ) );
+                    playlistDirs.insert( dirPath );
+                }
+                else
+                    mkvFiles.emplace_back( NDirWalker::filePath( dirPath, ii ) );
+            }
+        }
+    }
 
-        if ( info.isDir() )
+    {
+        SCAN_PHASE( "items" );
+        for ( auto&& m3uInfo : m3uFiles )
         {
-            auto item = new QTreeWidgetItem( parent, QStringList() << relPath, eParentDir );
-            fItemMap[relPath] = item;
+            auto parent = getParent( m3uInfo );
+            Q_ASSERT( parent );
+            loadM3UItem( m3uInfo, parent );
         }
-        else
+
+        for ( auto&& mkvInfo : mkvFiles )
         {
-            loadM3UItem( info, parent, &dlg );
+            if ( dlg.wasCanceled() )
+                break;
+            if ( hasPlaylistRoot( mkvInfo.absolutePath(), playlistDirs ) )
+                loadMKVItem( mkvInfo );
         }
     }
+    fStatsPanel->finishScan();
 
     QApplication::restoreOverrideCursor();
     qApp->processEvents();
@@ -168,42 +213,36 @@ QDir CMainWindow::relToDir() const
     return QDir( fImpl->dir->text() );
 }
 
-void CMainWindow::loadM3UItem( const QFileInfo & info, QTreeWidgetItem* parent, QProgressDialog* dlg )
+void CMainWindow::loadM3UItem( const QFileInfo & info, QTreeWidgetItem* parent )
 {
     auto relPath = relToDir().relativeFilePath( info.absoluteFilePath() );
     auto m3uItem = new QTreeWidgetItem( parent, QStringList() << relPath, eM3U );
+    NScanStats::add( NScanStats::eItemsCreated );
     fItemMap[relPath] = m3uItem;
+}
 
-    QDirIterator ii( info.absolutePath(), QStringList() << "*.mkv", QDir::Filter::AllEntries | QDir::NoDotAndDotDot | QDir::NoSymLinks, QDirIterator::IteratorFlag::Subdirectories );
-    dlg->setValue( dlg->value() + 1 );
-
-    while( ii.hasNext() )
-    {
-        qApp->processEvents();
-        if ( dlg->wasCanceled() )
-            return;
-
-        ii.next();
-
-        relPath = relToDir().relativeFilePath( ii.filePath() );
-        auto parent = getParent( ii.fileInfo() );
-        if ( ii.fileInfo().isDir() )
-        {
-            auto item = new QTreeWidgetItem( parent, QStringList() << relPath, eParentDir );
-            fItemMap[relPath] = item;
-        }
-        else // mkv file
-        {
-            auto mkvItem = new QTreeWidgetItem( parent, QStringList() << relPath, eMKV );
-            fItemMap[relPath] = mkvItem;
-        }
-    }
+void CMainWindow::loadMKVItem( const QFileInfo & info )
+{
+    auto relPath = relToDir().relativeFilePath( info.absoluteFilePath() );
+    auto parent = getParent( info );
+    auto mkvItem = new QTreeWidgetItem( parent, QStringList() << relPath, eMKV );
+    NScanStats::add( NScanStats::eItemsCreated );
+    fItemMap[relPath] = mkvItem;
 }
 
-bool CMainWindow::hasChildDirs(const QFileInfo& info) const
+bool CMainWindow::hasPlaylistRoot( const QString & dir, const std::unordered_set< QString > & playlistDirs ) const
 {
-    QDirIterator jj(info.absoluteFilePath(), QStringList() << "*.*" << "*", QDir::Filter::AllDirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
-    return jj.hasNext();
+    auto rootPath = relToDir().absolutePath();
+    for( auto currDir = dir; currDir.length() >= rootPath.length(); )
+    {
+        if ( playlistDirs.find( currDir ) != playlistDirs.end() )
+            return true;
+        auto pos = currDir.lastIndexOf( '/' );
+        if ( pos <= 0 )
+            break;
+        currDir = currDir.left( pos );
+    }
+    return false;
 }
 
 bool CMainWindow::skipDir(const QString& path) const
@@ -250,6 +289,7 @@ QTreeWidgetItem* CMainWindow::getParent(const QFileInfo & fileInfo ) const
         Q_ASSERT( parent );
 
         retVal = new QTreeWidgetItem( parent, QStringList() << path, eParentDir );
+        NScanStats::add( NScanStats::eItemsCreated );
         retVal->setExpanded( true );
         fItemMap[path] = retVal;
         return retVal;
@@ -257,67 +297,67 @@ QTreeWidgetItem* CMainWindow::getParent(const QFileInfo & fileInfo ) const
     return retVal;
 }
 
-int CMainWindow::getNumDirs(const QString& dir, QProgressDialog * dlg ) const
-{
-    qApp->processEvents();
-    QDirIterator ii(dir, QStringList() << "*.m3u", QDir::Filter::AllEntries | QDir::NoDotAndDotDot | QDir::NoSymLinks, QDirIterator::IteratorFlag::Subdirectories);
-
-    int cnt = 0;
-    while (ii.hasNext())
-    {
-        ii.next();
-        if (dlg->wasCanceled())
-            break;
-
-        if (skipDir(ii.fileName()))
-            continue;
-
-        if ( cnt % 5 == 0 )
-            qApp->processEvents();
-        cnt++;
-    }
-    return cnt;
-}
-
 void CMainWindow::slotTransform()
 {
-    QProgressDialog dlg(tr("Computing Number of M3U Files to fix..."), "Cancel", 0, 0, this);
+    TRACE_SCOPE( "rename", "CMainWindow::slotTransform" );
+    // the playlist pass reads every M3U, its counters replace the load's
+    fStatsPanel->startScan();
+    // the indexes are built here on the GUI thread, the pool only reads them
+    fMovieIndexes.clear();
+    std::vector< SM3UJob > jobs;
+    for ( int ii = 0; ii < fImpl->directories->topLevelItemCount(); ++ii )
+        collectM3UJobs( fImpl->directories->topLevelItem( ii ), jobs );
+
+    QProgressDialog dlg(tr("Fixing M3Us..."), "Cancel", 0, static_cast< int >( jobs.size() ), this);
     dlg.setMinimumDuration(0);
-    dlg.setValue(1);
-
-    int numDirs = getNumM3UToFix( &dlg );
-    if (dlg.wasCanceled())
-        return;
-    dlg.setLabelText(tr("Fixing M3Us..."));
-    dlg.setRange(0, numDirs);
     dlg.setValue(0);
 
-    for (auto&& ii = 0; ii < fImpl->directories->topLevelItemCount(); ++ii)
+    QString errorMsg;
+    CM3UState state( relToDir().absolutePath() );
+    if ( !state.load( errorMsg ) )
+        QMessageBox::warning( this, tr( "Could not load state" ), tr( "%1\nAll playlists will be checked." ).arg( errorMsg ) );
+
+    CM3URewriter rewriter( relToDir().absolutePath(), static_cast< CM3UFile::EBackupMode >( fImpl->backupMode->currentIndex() ) );
+    rewriter.setState( &state, fImpl->onlyChanged->isChecked() );
+    rewriter.start( std::move( jobs ) );
+    while ( !rewriter.waitForDone( 50 ) )
     {
+        if ( dlg.wasCanceled() )
+            rewriter.cancel();
+        dlg.setValue( rewriter.numCompleted() );
         qApp->processEvents();
-        transform(fImpl->directories->topLevelItem(ii), ii, &dlg);
+    }
+    dlg.setValue( rewriter.numJobs() );
+    fStatsPanel->finishScan();
+    statusBar()->showMessage( tr( "%1 M3U files processed, %2 were already correct, %3 skipped as unchanged since the last run" ).arg( rewriter.numJobs() ).arg( rewriter.numUnchanged() ).arg( rewriter.numSkipped() ) );
+
+    if ( !state.save( errorMsg ) )
+        QMessageBox::warning( this, tr( "Could not save state" ), errorMsg );
+
+    auto errors = rewriter.errors();
+    if ( !errors.isEmpty() )
+    {
+        QMessageBox msgBox( QMessageBox::Warning, tr( "Could not fix M3Us" ), tr( "%1 of %2 M3U files could not be fixed." ).arg( errors.count() ).arg( rewriter.numJobs() ), QMessageBox::Ok, this );
+        msgBox.setDetailedText( errors.join( "\n" ) );
+        msgBox.exec();
     }
 }
 
-int CMainWindow::getNumM3UToFix( QProgressDialog * dlg, QTreeWidgetItem * item ) const
+void CMainWindow::collectM3UJobs( QTreeWidgetItem * item, std::vector< SM3UJob >& jobs ) const
 {
-    if (dlg->wasCanceled())
-        return 0;
-
-    int retVal = (item && ( item->type() == ENodeType::eM3U ) ) ? 1 : 0;
+    if ( !item )
+        return;
 
-    for (int ii = 0; ii < (item ? item->childCount() : fImpl->directories->topLevelItemCount() ); ++ii )
+    if ( item->type() == eM3U )
     {
-        if (dlg->wasCanceled())
-            break;
-
-        auto child = item ? item->child( ii ) : fImpl->directories->topLevelItem( ii );
-        if (!child)
-            continue;
-        retVal += getNumM3UToFix(dlg, child);
+        SM3UJob job;
+        job.fPath = relToDir().absoluteFilePath( item->text( 0 ) );
+        job.fIndex = &getMovieIndex( item->parent() );
+        jobs.push_back( job );
     }
 
-    return retVal;
+    for ( int ii = 0; ii < item->childCount(); ++ii )
+        collectM3UJobs( item->child( ii ), jobs );
 }
 
 QString CMainWindow::getPath( QTreeWidgetItem* item ) const
@@ -333,90 +373,6 @@ QString CMainWindow::getPath( QTreeWidgetItem* item ) const
     }
 }
 
-void CMainWindow::generateM3U( QTreeWidgetItem * item ) const
-{
-    if ( !item )
-        return;
-    auto path = relToDir().absoluteFilePath( item->text( 0 ));
-
-    QFile fi( path );
-    fi.open( QFile::ReadOnly | QFile::Text );
-    if ( !fi.isOpen() )
-    {
-        QMessageBox::critical( nullptr, QString( "Could not open" ), QString( "Could not open file '%1'" ).arg( path ) );
-        return;
-    }
-    QString currLine;
-    std::list< std::pair< QString, QString > > files;
-
-    QString prevInf;
-
-    while( !fi.atEnd() )
-    {
-        currLine = fi.readLine().trimmed();
-        if ( currLine.isEmpty() )
-            continue;
-        else if ( currLine == "#EXTM3U" )
-            continue;
-        else if ( currLine.startsWith( "#EXTINF" ) )
-        {
-            prevInf = QUrl::fromPercentEncoding( currLine.toUtf8() );
-            QRegularExpression regExp( "(?<prefix>.*,)\\s*\\d+\\s*-\\s*(?<name>.*)" );
-            auto match = regExp.match( prevInf );
-            if ( match.hasMatch() )
-            {
-                auto name = match.captured( "name" ).trimmed();
-                auto prefix = match.captured( "prefix" ).trimmed();
-                prevInf = prefix + name;
-            }
-        }
-        else 
-        {
-            auto fileName = QUrl::fromPercentEncoding( currLine.toUtf8() );
-            QRegularExpression regExp( "\\d+\\s*-\\s*(?<name>.*)" );
-            auto match = regExp.match( fileName );
-            if ( match.hasMatch() )
-            {
-                fileName = match.captured( "name" ).trimmed();
-            }
-
-            files.push_back( std::make_pair( prevInf,fileName ) );
-            prevInf.clear();
-        }
-    }
-
-    fi.close();
-    auto fileName = QFileInfo( path ).absoluteFilePath() + ".bak";
-    QFile::remove( fileName );
-    if ( !fi.rename( fileName ) )
-    {
-        QMessageBox::critical( nullptr, QString( "Could not backup" ), QString( "Could not backup file '%1' to '%2'" ).arg( path ).arg( fileName ) );
-        return;
-    }
-
-    QFile outFile = QFile( path );
-    outFile.open( QFile::WriteOnly | QFile::Text );
-    if ( !outFile.isOpen() )
-    {
-        QMessageBox::critical( nullptr, QString( "Could not open" ), QString( "Could not create file '%1'" ).arg( path ) );
-        return;
-    }
-    QTextStream ts( &outFile );
-    ts << "#EXTM3U" << "\n";
-    for( auto && ii : files )
-    {
-        if ( !ii.first.isEmpty() && !ii.second.isEmpty() )
-            ts << ii.first << "\n";
-        if ( !ii.second.isEmpty() )
-        {
-            auto dir = QDir( QFileInfo( path ).absolutePath() );
-            auto moviePath = getMoviePath( dir, ii.second, item );
-            ts << QUrl::toPercentEncoding( moviePath ) << "\n";
-        }
-    }
-    outFile.close();
-}
-
 std::list< QTreeWidgetItem * > CMainWindow::getMovies( QTreeWidgetItem * item ) const
 {
     std::list< QTreeWidgetItem* > retVal;
@@ -434,63 +390,16 @@ std::list< QTreeWidgetItem * > CMainWindow::getMovies( QTreeWidgetItem * item )
     return retVal;
 }
 
-QString CMainWindow::getMoviePath( const QDir& dir, const QString& origName, QTreeWidgetItem * item ) const
-{
-    if ( QFileInfo( dir.absoluteFilePath( origName ) ).exists() )
-        return origName;
-
-    QRegularExpression regExp( "\\d+\\s*-\\s*(?<name>.*)" );
-    auto match = regExp.match( origName );
-    if ( match.hasMatch() )
-    {
-        auto name = match.captured( "name" );
-        return getMoviePath( dir, name, item );
-    }
-
-    auto mkvFiles = getMovies( item->parent() );
-    for( auto && ii : mkvFiles )
-    {
-        auto relPath = ii->text( 0 );
-        auto pos = relPath.lastIndexOf( "/" );
-        auto fileName = relPath;
-        if ( pos != -1 )
-        {
-            fileName = fileName.mid( pos + 1 );
-        }
-        if ( ( origName == fileName ) || ( QFileInfo( origName ).baseName() == QFileInfo( fileName ).baseName() ) )
-        {
-            // found it
-            auto absPath = relToDir().absoluteFilePath( relPath );
-            auto itemDir = QFileInfo( relToDir().absoluteFilePath( item->text( 0 ) ) ).absolutePath();
-
-            auto retVal = QDir( itemDir ).relativeFilePath( absPath );
-            return retVal;
-        }
-    }
-    return origName;
-}
-
-void CMainWindow::transform( QTreeWidgetItem * item, int /*pos*/, QProgressDialog * dlg)
+const SMovieIndex& CMainWindow::getMovieIndex( QTreeWidgetItem* root ) const
 {
-    if (dlg->wasCanceled())
-        return;
-
-    if (!item)
-        return;
-
-    if ( item->type() == eM3U )
-    {
-        generateM3U( item );
-    }
-
-    for( int ii = 0; ii < item->childCount(); ++ii )
-    {
-        if (dlg->wasCanceled())
-            return;
-        transform(item->child(ii), ii, dlg);
-    }
+    auto pos = fMovieIndexes.find( root );
+    if ( pos != fMovieIndexes.end() )
+        return ( *pos ).second;
+
+    // the map is node based so the returned reference stays valid as more roots are added
+    auto&& retVal = fMovieIndexes[root];
+    auto mkvFiles = getMovies( root );
+    for ( auto&& ii : mkvFiles )
+        retVal.add( ii->text( 0 ) );
+    return retVal;
 }
-
-
-
-
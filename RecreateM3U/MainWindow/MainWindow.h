@@ -24,9 +24,14 @@
 #define _MAINWINDOW_H
 
 #include <QDir>
+#include <unordered_set>
+#include <vector>
+#include "M3UFile.h"
 class QTreeWidgetItem;
 class QFileInfo;
 class QProgressDialog;
+class CScanStatsPanel;
+struct SM3UJob;
 #include <QMainWindow>
 
 namespace Ui {class CMainWindow;};
@@ -56,23 +61,23 @@ private:
 
     QDir relToDir() const;
     QString getPath( QTreeWidgetItem* item ) const;
-    void generateM3U( QTreeWidgetItem* item ) const;
 
-    bool hasChildDirs(const QFileInfo& lhsInfo ) const;
     std::list< QTreeWidgetItem* > getMovies( QTreeWidgetItem* item ) const;
-    QString getMoviePath( const QDir& dir, const QString& origName, QTreeWidgetItem* item ) const;
+    const SMovieIndex& getMovieIndex( QTreeWidgetItem* root ) const;
 
     bool skipDir(const QString& path) const;
-    void transform(QTreeWidgetItem* item, int pos, QProgressDialog * dlg);
+    void collectM3UJobs( QTreeWidgetItem* item, std::vector< SM3UJob >& jobs ) const;
 
-    int getNumDirs( const QString & dir, QProgressDialog * dlg ) const;
-    int getNumM3UToFix(QProgressDialog* dlg, QTreeWidgetItem* parent = nullptr) const;
-    void loadM3UItem( const QFileInfo & info, QTreeWidgetItem* parent, QProgressDialog* dlg );
+    void loadM3UItem( const QFileInfo & info, QTreeWidgetItem* parent );
+    void loadMKVItem( const QFileInfo & info );
+    bool hasPlaylistRoot( const QString & dir, const std::unordered_set< QString > & playlistDirs ) const;
 
     QTreeWidgetItem* getItem(const QString & info) const;
     QTreeWidgetItem* getParent(const QFileInfo& info) const;
 
     mutable std::unordered_map< QString, QTreeWidgetItem* > fItemMap;
+    mutable std::unordered_map< QTreeWidgetItem*, SMovieIndex > fMovieIndexes; // built once per playlist root
+    CScanStatsPanel* fStatsPanel{ nullptr };
     std::unique_ptr< Ui::CMainWindow > fImpl;
 };
 
@@ -22,6 +22,10 @@
 
 set(qtproject_SRCS
     MainWindow.cpp
+    M3UFile.cpp
+    M3URewriter.cpp
+    M3UParser.cpp
+    M3UState.cpp
 )
 
 set(qtproject_H
@@ -29,6 +33,10 @@ set(qtproject_H
 )
 
 set(project_H
+    M3UFile.h
+    M3URewriter.h
+    M3UParser.h
+    M3UState.h
 )
 
 set(qtproject_UIS
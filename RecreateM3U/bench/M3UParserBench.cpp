@@ -0,0 +1,174 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "M3UParserBench.h"
+#include "MainWindow/M3UParser.h"
+#include "MainWindow/M3UFile.h"
+
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QFile>
+#include <QUrl>
+
+#include <iostream>
+
+// Writes a synthetic playlist of the given number of entries, a mix of plain, track numbered and percent encoded names
+static QString createPlaylist( const QTemporaryDir & dir, int numEntries )
+{
+    auto path = dir.filePath( QString( "bench_%1.m3u" ).arg( numEntries ) );
+    QFile fi( path );
+    if ( !fi.open( QFile::WriteOnly ) )
+        return QString();
+
+    QTextStream ts( &fi );
+    ts << "#EXTM3U\n";
+    for ( int ii = 0; ii < numEntries; ++ii )
+    {
+        auto name = QString( "Movie Title Number %1 (%2)" ).arg( ii ).arg( 1950 + ( ii % 70 ) );
+        if ( ( ii % 3 ) == 0 )
+            name = QString( "%1 - %2" ).arg( ii % 100, 2, 10, QChar( '0' ) ).arg( name );
+        ts << "#EXTINF:" << ( 5400 + ii % 1800 ) << "," << name << "\n";
+        if ( ( ii % 2 ) == 0 )
+            ts << QUrl::toPercentEncoding( "../Movies/" + name + "/" + name + ".mkv", "/" ) << "\n";
+        else
+            ts << "../Movies/" << name << "/" << name << ".mkv\n";
+    }
+    return path;
+}
+
+int runParserBench( int maxEntries, int iterations )
+{
+    QTemporaryDir tmpDir;
+    if ( !tmpDir.isValid() )
+    {
+        std::cerr << "Could not create temporary directory" << std::endl;
+        return 1;
+    }
+
+    for ( int numEntries = 1000; numEntries <= maxEntries; numEntries *= 10 )
+    {
+        auto path = createPlaylist( tmpDir, numEntries );
+        if ( path.isEmpty() )
+        {
+            std::cerr << "Could not create playlist" << std::endl;
+            return 1;
+        }
+
+        for ( auto && computeHash : { false, true } )
+        {
+            CM3UParser parser( computeHash );
+            size_t numPaths = 0;
+            size_t numStripped = 0;
+            QString errorMsg;
+            QElapsedTimer timer;
+            timer.start();
+            for ( int ii = 0; ii < iterations; ++ii )
+            {
+                auto aOK = parser.parseFile( path,
+                    [ &numPaths, &numStripped ]( CM3UParser::ELineType type, std::string_view line )
+                    {
+                        if ( type != CM3UParser::ePath )
+                            return;
+                        numPaths++;
+                        if ( !CM3UParser::stripTrackNumber( line ).empty() )
+                            numStripped++;
+                    }, errorMsg );
+                if ( !aOK )
+                {
+                    std::cerr << qPrintable( errorMsg ) << std::endl;
+                    return 1;
+                }
+            }
+            auto nsecs = std::max< qint64 >( 1, timer.nsecsElapsed() );
+            auto mbytes = static_cast< double >( parser.size() ) * iterations / ( 1024.0 * 1024.0 );
+            std::cout << numEntries << " entries" << ( computeHash ? " (with hash)" : "" ) << ": "
+                << parser.size() << " bytes, "
+                << ( nsecs / iterations / 1000 ) << " us per parse, "
+                << ( mbytes * 1e9 / nsecs ) << " MB/s"
+                << " (" << numPaths / iterations << " paths, " << numStripped / iterations << " with track numbers)" << std::endl;
+        }
+    }
+    return 0;
+}
+
+int runParserCheck()
+{
+    QTemporaryDir tmpDir;
+    if ( !tmpDir.isValid() )
+    {
+        std::cerr << "Could not create temporary directory" << std::endl;
+        return 1;
+    }
+
+    // already in the form generate writes, so it must come back byte for byte
+    auto header = QString( "#EXTM3U url-tvg=\"http://localhost/guide.xml\" tvg-shift=\"0\"" );
+    auto path = tmpDir.filePath( "attributed.m3u" );
+    {
+        QFile fi( path );
+        if ( !fi.open( QFile::WriteOnly | QFile::Text ) )
+        {
+            std::cerr << "Could not create playlist" << std::endl;
+            return 1;
+        }
+        QTextStream ts( &fi );
+        ts << header << "\n"
+           << "#EXTINF:5400,Movie\n"
+           << "Movie.mkv\n";
+    }
+
+    QString seenHeader;
+    QString errorMsg;
+    CM3UParser parser;
+    auto aOK = parser.parseFile( path,
+        [ &seenHeader ]( CM3UParser::ELineType type, std::string_view line )
+        {
+            if ( type == CM3UParser::eHeader )
+                seenHeader = CM3UParser::toQString( line );
+        }, errorMsg );
+    if ( !aOK )
+    {
+        std::cerr << qPrintable( errorMsg ) << std::endl;
+        return 1;
+    }
+    if ( seenHeader != header )
+    {
+        std::cerr << "Attributed header not parsed as the header, got '" << qPrintable( seenHeader ) << "'" << std::endl;
+        return 1;
+    }
+
+    CM3UFile file( path );
+    if ( !file.read( errorMsg ) )
+    {
+        std::cerr << qPrintable( errorMsg ) << std::endl;
+        return 1;
+    }
+    auto contents = file.generate();
+    if ( !file.isUnchanged( contents ) )
+    {
+        std::cerr << "Attributed header not written back, got:" << std::endl << contents.constData() << std::endl;
+        return 1;
+    }
+    std::cout << "M3U parser checks passed" << std::endl;
+    return 0;
+}
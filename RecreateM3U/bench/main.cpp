@@ -0,0 +1,74 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "MainWindow/MainWindow.h"
+#include "M3UParserBench.h"
+#include "Common/Benchmark.h"
+
+#include <QApplication>
+#include <QTreeWidget>
+
+#include <algorithm>
+
+int main( int argc, char ** argv )
+{
+    CBenchmark::setHeadless();
+    Q_INIT_RESOURCE( application );
+    QApplication appl( argc, argv );
+    appl.setApplicationName( "RecreateM3UBench" );
+    appl.setOrganizationName( "Scott Aron Bloom" );
+    appl.setOrganizationDomain( "www.towel42.com" );
+
+    CBenchmark bench( "Times the RecreateM3U directory load on synthetic libraries, or the M3U parser on synthetic playlists" );
+    QCommandLineOption parserOption( "parser", "Measure the M3U parser throughput instead, on playlists of up to the largest --entries" );
+    QCommandLineOption checkOption( "check", "Verify the M3U parser round trips known playlists and exit" );
+    bench.cmdLine().addOption( parserOption );
+    bench.cmdLine().addOption( checkOption );
+    bench.process( appl );
+
+    if ( bench.cmdLine().isSet( checkOption ) )
+        return runParserCheck();
+
+    if ( bench.cmdLine().isSet( parserOption ) )
+        return runParserBench( *std::max_element( bench.entries().begin(), bench.entries().end() ), bench.iterations() );
+
+    CMainWindow mainWindow;
+    appl.processEvents();
+    auto directories = mainWindow.findChild< QTreeWidget * >( "directories" );
+
+    // slotDirectoryChanged resets the window and queues the load, which is what the user triggers
+    bench.addCase( "CMainWindow::slotLoad",
+        [ &mainWindow, directories ]( const QString & rootDir, QString & errorMsg )
+        {
+            if ( !CBenchmark::setDirectory( &mainWindow, "dir", rootDir, errorMsg ) )
+                return false;
+            mainWindow.slotDirectoryChanged();
+            qApp->processEvents();
+            if ( !directories || !directories->topLevelItemCount() )
+            {
+                errorMsg = "The directory was not loaded";
+                return false;
+            }
+            return true;
+        } );
+    return bench.run();
+}
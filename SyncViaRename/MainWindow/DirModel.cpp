@@ -21,7 +21,7 @@
 // SOFTWARE.
 
 #include "DirModel.h"
-#include <QDebug>
+#include "Common/Log.h"
 #include <QUrl>
 #include <QInputDialog>
 #include <QTextStream>
@@ -31,6 +31,9 @@
 #include <QUrl>
 #include <set>
 #include <list>
+
+static NLog::CCategory sLog( "dirmodel" );
+
 CDirModel::CDirModel(QObject* parent /*= 0*/) :
     QFileSystemModel(parent)
 {
@@ -309,7 +312,7 @@ int CDirModel::computeDepth( const QModelIndex & idx ) const
 {
     if ( !idx.isValid() )
         return 0;
-    qDebug().nospace().noquote() << "Computing Depth for " << idx.data();
+    LOG_TRACE( sLog, "Computing Depth for %1", idx.data() );
     if (idx == rootIndex())
         return 0;
     auto parent = idx.parent();
@@ -347,7 +350,7 @@ bool CDirModel::acceptRow( const QModelIndex & srcIdx, int depth) const
     if (isDir && canFetchMore(srcIdx))
         return true;
 
-    qDebug().nospace().noquote() << indent(depth) << "Checking to see if " << ( isDir ? "Dir" : "File" ) << srcIdx.data() << " should be shown";
+    LOG_TRACE( sLog, "%1Checking to see if %2 %3 should be shown", indent( depth ), isDir ? "Dir" : "File", srcIdx.data() );
     if (isDir)
     {
         QRegularExpression regExp("\\[tmdbid\\=\\d+\\].*$");
@@ -372,7 +375,7 @@ bool CDirModel::acceptRow( const QModelIndex & srcIdx, int depth) const
             else 
             {
                 auto fi = fileInfo(idx);
-                qDebug() << fi.absoluteFilePath();
+                LOG_TRACE( sLog, "Checking file %1", fi.absoluteFilePath() );
                 if (fi.suffix().toLower() == "mkv")
                     return true;
             }
@@ -22,22 +22,34 @@
 
 #include "MainWindow.h"
 #include "DirModel.h"
+#include "RHSIndex.h"
 #include "SABUtils/utils.h"
 #include "SABUtils/ScrollMessageBox.h"
 #include "SABUtils/ButtonEnabler.h"
+#include "Common/Trace.h"
+#include "Common/DirCompleter.h"
+#include "Common/DirWalker.h"
+#include "Common/Log.h"
+#include "Common/ScanStats.h"
+#include "Common/ScanStatsPanel.h"
 #include "ui_MainWindow.h"
 
 #include <QSettings>
 #include <QFileInfo>
 #include <QFileDialog>
-#include <QCompleter>
 #include <QMessageBox>
 #include <QDate>
 #include <QDesktopServices> 
 #include <QTimer>
 #include <QProgressDialog>
 #include <QScrollBar>
-#include <QDebug>
+#include <QStatusBar>
+#include <QPushButton>
+#include <deque>
+
+static NLog::CCategory sLoadLog( "load" );
+static NLog::CCategory sRenameLog( "rename" );
+static const size_t kItemsPerPass = 500;
 
 CMainWindow::CMainWindow(QWidget* parent)
     : QMainWindow(parent),
@@ -53,21 +65,30 @@ CMainWindow::CMainWindow(QWidget* parent)
     connect(fImpl->btnSelectRHSDir, &QPushButton::clicked, this, &CMainWindow::slotSelectRHSDirectory);
     connect(fImpl->btnTransform, &QPushButton::clicked, this, &CMainWindow::slotTransform);
 
-    auto completer = new QCompleter(this);
-    auto fsModel = new QFileSystemModel(completer);
-    fsModel->setRootPath("");
-    completer->setModel(fsModel);
-    completer->setCompletionMode(QCompleter::PopupCompletion);
-    completer->setCaseSensitivity(Qt::CaseInsensitive);
+    auto completer = new CDirCompleter(this);
+    completer->addLineEdit(fImpl->lhsDir);
+    completer->addLineEdit(fImpl->rhsDir);
+
+    fStatsPanel = new CScanStatsPanel(this);
+    addDockWidget(Qt::BottomDockWidgetArea, fStatsPanel);
+    menuBar()->addMenu(tr("&View"))->addAction(fStatsPanel->toggleViewAction());
+    restoreState(QSettings().value("WindowState").toByteArray());
 
-    fImpl->lhsDir->setCompleter(completer);
-    fImpl->rhsDir->setCompleter(completer);
+    fLoadTimer = new QTimer(this);
+    fLoadTimer->setSingleShot(true);
+    connect(fLoadTimer, &QTimer::timeout, this, &CMainWindow::slotShowFound);
+
+    fCancelLoad = new QPushButton(tr("Cancel"), this);
+    fCancelLoad->setVisible(false);
+    statusBar()->addPermanentWidget(fCancelLoad);
+    connect(fCancelLoad, &QPushButton::clicked, this, &CMainWindow::slotCancelLoad);
 
     QTimer::singleShot(0, this, &CMainWindow::slotDirectoryChanged);
 }
 
 CMainWindow::~CMainWindow()
 {
+    stopLoading();
     saveSettings();
 }
 
@@ -85,6 +106,7 @@ void CMainWindow::saveSettings()
 
     settings.setValue("LHSDirectory", fImpl->lhsDir->text());
     settings.setValue("RHSDirectory", fImpl->rhsDir->text());
+    settings.setValue("WindowState", saveState());
 }
 
 void CMainWindow::slotDirectoryChanged()
@@ -119,138 +141,288 @@ void CMainWindow::slotLoad()
 
 void CMainWindow::loadDirectory()
 {
-    QApplication::setOverrideCursor(Qt::WaitCursor);
+    TRACE_SCOPE( "scan", "CMainWindow::loadDirectory" );
+    stopLoading();
+    fStatsPanel->startScan();
 
     fDirMap.clear();
+    fRHSClaims.clear();
     fImpl->directories->clear();
     fImpl->directories->setHeaderLabels(QStringList() << "LHS Name" << "RHS Name");
     auto header = fImpl->directories->header();
     header->setSectionResizeMode(QHeaderView::ResizeToContents);
 
-    QProgressDialog dlg(tr("Computing Number of Directories..."), "Cancel", 0, 0, this);
-    dlg.setMinimumDuration(0);
-    dlg.setValue(1);
-
-    int numDirs = getNumDirs( fImpl->lhsDir->text(), &dlg );
-    if (dlg.wasCanceled())
-        return;
-    dlg.setLabelText(tr("Finding Directories..."));
-    dlg.setRange(0, numDirs);
-    dlg.setValue(0);
-
     auto rootDir = new QTreeWidgetItem(fImpl->directories, QStringList() << ".", 1);
     rootDir->setExpanded(true);
     fDirMap["."] = rootDir;
+    NScanStats::add(NScanStats::eItemsCreated);
 
-    QDirIterator ii(fImpl->lhsDir->text(), QStringList() << "*.*" << "*", QDir::Filter::AllDirs | QDir::NoDotAndDotDot | QDir::NoSymLinks, QDirIterator::IteratorFlag::Subdirectories);
+    fFound = std::make_shared< CBatchQueue< SFoundDir > >();
+    fCanceled = false;
+    fLoadTask = std::async(std::launch::async, [this, lhsDir = fImpl->lhsDir->text(), rhsDir = fImpl->rhsDir->text(), found = fFound]() { findDirs(lhsDir, rhsDir, *found); });
 
-    auto lhsRelToDir = QDir(fImpl->lhsDir->text());
-    auto rhsRelToDir = QDir(fImpl->rhsDir->text());
+    setLoading(true);
+    fLoadTimer->start(0);
+}
 
-    int cnt = 0;
-    while (ii.hasNext())
-    {
-        if (dlg.wasCanceled())
-            break;
-        ii.next();
-        if ( skipDir(ii.fileName() ) )
-            continue;
-        cnt++;
-        dlg.setValue(cnt);
-        qApp->processEvents();
+void CMainWindow::stopLoading()
+{
+    fLoadTimer->stop();
+    fCanceled = true;
+    if (fLoadTask.valid())
+        fLoadTask.wait();
+    fLoadTask = std::future< void >();
+    fFound.reset();
+}
 
-        auto lhsInfo = ii.fileInfo();
+void CMainWindow::setLoading(bool loading)
+{
+    fImpl->btnTransform->setEnabled(!loading);
+    fCancelLoad->setVisible(loading);
+    if (loading)
+        statusBar()->showMessage(tr("Finding Directories..."));
+    else
+        statusBar()->clearMessage();
+}
 
-        QRegularExpression regExp("^(?<basename>.*)\\s*\\((?<year>\\d{4})\\)\\s*(-\\s*.*)?\\s*\\[(tmdbid|imdbid)\\=.*\\]$");
-        auto leafName = lhsInfo.fileName();
-        auto match = regExp.match(leafName);
-        ENodeType type = eOK;
-        if (!match.hasMatch())
+void CMainWindow::findDirs(const QString& lhsDir, const QString& rhsDir, CBatchQueue< SFoundDir >& found) const
+{
+    TRACE_SCOPE( "scan", "CMainWindow::findDirs" );
+    // the RHS is indexed while the LHS is walked, directories found before the index is ready are shown as
+    // pending right away and classified again once it is
+    auto rhsTask = std::async(std::launch::async, [this, rhsDir]() { CRHSIndex retVal; retVal.load(rhsDir, fCanceled); return retVal; });
+    CRHSIndex rhsIndex;
+    bool indexReady = false;
+    std::vector< std::pair< QString, bool > > unmatched; // relative path, has sub directories
+    auto matchWaiting = [&unmatched, &rhsIndex, &found]()
+    {
+        for (auto&& ii : unmatched)
+            found.push(classify(ii.first, ii.second, rhsIndex));
+        unmatched.clear();
+    };
+
+    SCAN_PHASE( "walk" );
+    // breadth first, so the top of the tree shows up right away and every parent is reported before its children.
+    // A directory is classified once it has been read, as whether it has sub directories matters
+    auto lhsRelToDir = QDir(lhsDir);
+    std::deque< QString > pending;
+    pending.push_back(lhsRelToDir.absolutePath());
+    std::vector< NDirWalker::SEntry > entries;
+    bool isRoot = true;
+    while (!pending.empty() && !fCanceled)
+    {
+        auto dirPath = std::move(pending.front());
+        pending.pop_front();
+
+        // the listing says which entries are directories, nothing is stat'ed
+        NDirWalker::readDir(dirPath, entries);
+        bool hasChildDirs = false;
+        for (auto&& ii : entries)
         {
-            if ( !hasChildDirs(lhsInfo) )
-                type = eBadFileName;
+            if (!ii.fIsDir)
+                continue;
+            hasChildDirs = true;
+            // the skipped directories aren't shown, so nothing under them can be either
+            if (!skipDir(ii.fName))
+                pending.push_back(NDirWalker::filePath(dirPath, ii));
         }
 
-        regExp = QRegularExpression(".*\\s{2,}");
-        match = regExp.match(leafName);
-        if (match.hasMatch())
-            type = eBadFileName;
-
-        auto relPath = lhsRelToDir.relativeFilePath(ii.filePath());
-        //qDebug() << "Working on " << relPath;
-        //auto rhsInfo = QFileInfo(rhsRelToDir.absoluteFilePath(relPath));
+        if (isRoot)
+        {
+            isRoot = false;
+            continue;
+        }
 
-        auto parent = getParent(lhsInfo);
-        Q_ASSERT(parent);
+        if (!indexReady && (rhsTask.wait_for(std::chrono::seconds(0)) == std::future_status::ready))
+        {
+            rhsIndex = rhsTask.get();
+            indexReady = true;
+            matchWaiting();
+        }
 
-        //QString rhsRelPathName = rhsInfo.exists() ? relPath : "";
-        //ENodeType type = eParentDir;
-        //if (!rhsInfo.exists())
-        //{
-        //    auto leafName = QFileInfo(relPath).fileName();
-        //    auto parentDir = parent->text(0);
-        //    QRegularExpression regExp("^(?<basename>.*)\\s*\\((?<year>\\d{4})\\)\\s*\\[(tmdbid|imdbid)\\=.*\\]$");
-        //    Q_ASSERT(regExp.isValid());
-
-        //    auto match = regExp.match( leafName );
-        //    if (match.hasMatch())            
-        //    {
-        //        auto relToDir = QDir(rhsRelToDir.absoluteFilePath(parentDir));
-        //        auto baseName = match.captured("basename").trimmed();
-        //        auto year = match.captured("year").trimmed();
-
-        //        auto rhsPath = relToDir.absoluteFilePath(baseName);
-        //        //qDebug() << "Checking RHS for" << rhsPath;
-        //        rhsInfo = QFileInfo( rhsPath );
-        //        if (!rhsInfo.exists())
-        //        {
-        //            // check to see if the year exists
-        //            rhsPath = relToDir.absoluteFilePath(baseName) + QString(" (%1)").arg(year);
-        //            //qDebug() << "Checking RHS for" << rhsPath;
-        //            rhsInfo = QFileInfo(rhsPath);
-        //        }
-
-        //        if (!rhsInfo.exists())
-        //        {
-        //            type = ENodeType::eMissingDir;
-        //        }
-        //        else
-        //        {
-        //            type = ENodeType::eOKDirToRename;
-        //            rhsRelPathName = rhsRelToDir.relativeFilePath(rhsInfo.filePath());
-        //        }
-        //    }
-        //    else // not a (year) [tmdb=] type of directory
-        //    {
-        //        type = eMissingDir;
-        //    }
-        //}
-
-        QTreeWidgetItem* item = new QTreeWidgetItem(parent, QStringList() << relPath, type);
-        if ( type == eOKDirToRename )
-            item->setBackground(0, Qt::green);
-        else if (type == eMissingDir)
+        auto relPath = lhsRelToDir.relativeFilePath(dirPath);
+        if (indexReady)
+            found.push(classify(relPath, hasChildDirs, rhsIndex));
+        else
         {
-            item->setBackground(0, Qt::red);
-            qDebug() << "Missing directory" << relPath;
+            found.push(SFoundDir{ relPath, ePending, QString() });
+            unmatched.emplace_back(relPath, hasChildDirs);
         }
-        else if (type == eBadFileName)
+    }
+
+    if (!indexReady)
+    {
+        rhsIndex = rhsTask.get();
+        matchWaiting();
+    }
+}
+
+CMainWindow::SFoundDir CMainWindow::classify(const QString& relPath, bool hasChildDirs, const CRHSIndex& rhsIndex)
+{
+    static thread_local QRegularExpression sNameRegExp("^(?<basename>.*)\\s*\\((?<year>\\d{4})\\)\\s*(-\\s*.*)?\\s*\\[(tmdbid|imdbid)\\=.*\\]$");
+    static thread_local QRegularExpression sSpacesRegExp(".*\\s{2,}");
+
+    SFoundDir retVal{ relPath, eOK, QString() };
+    auto leafName = QFileInfo(relPath).fileName();
+    auto match = sNameRegExp.match(leafName);
+    if (!match.hasMatch() && !hasChildDirs)
+        retVal.fType = eBadFileName;
+    if (sSpacesRegExp.match(leafName).hasMatch())
+        retVal.fType = eBadFileName;
+    NScanStats::add(NScanStats::eRegexEvals, 2);
+
+    if (rhsIndex.contains(relPath))
+        retVal.fRHSRelPath = relPath;
+    else if (retVal.fType != eBadFileName)
+    {
+        // a "Name (Year) [tmdbid=...]" directory can be renamed onto an RHS "Name" or "Name (Year)" in the same parent,
+        // or failing that onto the one whose name is closest
+        retVal.fType = eMissingDir;
+        if (match.hasMatch())
         {
-            item->setBackground(0, Qt::red);
-            qDebug() << "Bad file name" << relPath;
+            auto parentRelPath = QFileInfo(relPath).path();
+            auto baseName = match.captured("basename").trimmed();
+            auto year = match.captured("year").trimmed();
+            retVal.fRHSRelPath = rhsIndex.find(parentRelPath, baseName, year);
+            if (!retVal.fRHSRelPath.isEmpty())
+                retVal.fType = eOKDirToRename;
+            else
+            {
+                retVal.fRHSRelPath = rhsIndex.findClosest(parentRelPath, baseName, year);
+                if (!retVal.fRHSRelPath.isEmpty())
+                    retVal.fType = eFuzzyDirToRename;
+            }
         }
+    }
+    return retVal;
+}
+
+void CMainWindow::slotShowFound()
+{
+    TRACE_SCOPE( "classify", "CMainWindow::slotShowFound" );
+    // checked before taking what was found, so nothing pushed after the last take can be missed
+    bool finished = fLoadTask.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+
+    // a bounded batch per pass, the event loop gets a turn in between even when the walk is far ahead
+    {
+        SCAN_PHASE( "items" );
+        for (auto&& ii : fFound->take(kItemsPerPass))
+            addDirItem(ii);
+    }
+
+    if (!finished || !fFound->empty())
+    {
+        statusBar()->showMessage(tr("Finding Directories (%1 found)...").arg(static_cast< int >(fDirMap.size()) - 1));
+        fLoadTimer->start(fFound->empty() ? 100 : 0);
+        return;
+    }
+
+    fLoadTask = std::future< void >();
+    fFound.reset();
+    fStatsPanel->finishScan();
+    setLoading(false);
+    emit sigLoadFinished();
+}
+
+void CMainWindow::slotCancelLoad()
+{
+    // what was found so far stays in the tree
+    stopLoading();
+    fStatsPanel->finishScan();
+    setLoading(false);
+    statusBar()->showMessage(tr("Canceled"), 5000);
+}
+
+void CMainWindow::addDirItem(const SFoundDir& dir)
+{
+    auto&& relPath = dir.fRelPath;
+    auto type = dir.fType;
+    QTreeWidgetItem* item = nullptr;
+
+    auto pos = fDirMap.find(relPath);
+    if (pos != fDirMap.end())
+    {
+        // a pending row, classified now that the RHS index is ready.  It is updated in place, so its position and
+        // children are untouched
+        item = (*pos).second;
+        Q_ASSERT(nodeType(item) == ePending);
+        item->setText(1, dir.fRHSRelPath);
+        item->setData(0, Qt::ForegroundRole, QVariant());
+    }
+    else
+    {
+        item = new QTreeWidgetItem(QStringList() << relPath << dir.fRHSRelPath);
+        NScanStats::add(NScanStats::eItemsCreated);
+
+        // parents are always reported first, and the path is relative so the edit field can't have moved under it
+        auto parent = getItem(QFileInfo(relPath).path());
+        Q_ASSERT(parent);
+        parent->addChild(item);
         item->setExpanded(true);
         fDirMap[relPath] = item;
     }
+    item->setData(0, kNodeTypeRole, type);
 
-    QApplication::restoreOverrideCursor();
-    qApp->processEvents();
+    if (type == ePending)
+        item->setForeground(0, Qt::gray);
+    else if ( type == eOKDirToRename )
+        item->setBackground(0, Qt::green);
+    else if (type == eFuzzyDirToRename)
+    {
+        // a close match is only a guess, it is renamed once the user checks it
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(0, Qt::Unchecked);
+        item->setBackground(0, Qt::yellow);
+        LOG_DEBUG( sLoadLog, "Closest match for %1 is %2", relPath, dir.fRHSRelPath );
+    }
+    else if (type == eMissingDir)
+    {
+        item->setBackground(0, Qt::red);
+        LOG_DEBUG( sLoadLog, "Missing directory %1", relPath );
+    }
+    else if (type == eBadFileName)
+    {
+        item->setBackground(0, Qt::red);
+        LOG_DEBUG( sLoadLog, "Bad file name %1", relPath );
+    }
+
+    if (!dir.fRHSRelPath.isEmpty())
+        addRHSClaim(dir.fRHSRelPath, item);
 }
 
-bool CMainWindow::hasChildDirs(const QFileInfo& lhsInfo) const
+void CMainWindow::addRHSClaim(const QString& rhsRelPath, QTreeWidgetItem* item)
 {
-    QDirIterator jj(lhsInfo.absoluteFilePath(), QStringList() << "*.*" << "*", QDir::Filter::AllDirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
-    return jj.hasNext();
+    // two LHS directories pointing at the same RHS one would rename it twice, or rename it away from the one it already matches
+    auto&& claims = fRHSClaims[rhsRelPath];
+    claims.push_back(item);
+    if (claims.size() < 2)
+        return;
+    for (auto&& ii : claims)
+    {
+        ii->setBackground(1, Qt::red);
+        ii->setToolTip(1, tr("Claimed by more than one LHS directory, it will not be renamed"));
+    }
+    LOG_DEBUG( sLoadLog, "%1 is claimed by %2 LHS directories", rhsRelPath, static_cast< int >(claims.size()) );
+}
+
+CMainWindow::ENodeType CMainWindow::nodeType(const QTreeWidgetItem* item)
+{
+    return static_cast< ENodeType >(item->data(0, kNodeTypeRole).toInt());
+}
+
+bool CMainWindow::willRename(const QTreeWidgetItem* item) const
+{
+    auto type = nodeType(item);
+    if (type == ENodeType::eFuzzyDirToRename)
+    {
+        if (item->checkState(0) != Qt::Checked)
+            return false;
+    }
+    else if (type != ENodeType::eOKDirToRename)
+        return false;
+
+    auto pos = fRHSClaims.find(item->text(1));
+    return (pos == fRHSClaims.end()) || ((*pos).second.size() < 2);
 }
 
 bool CMainWindow::skipDir(const QString& path) const
@@ -282,40 +454,9 @@ QTreeWidgetItem * CMainWindow::getItem( const QString & path ) const
     return (*pos).second;
 }
 
-QTreeWidgetItem* CMainWindow::getParent(const QFileInfo & fileInfo ) const
-{
-    auto path = fileInfo.absolutePath();
-    auto relToDir = QDir(fImpl->lhsDir->text());
-    path = QDir(fImpl->lhsDir->text()).relativeFilePath(path);
-    if (path.isEmpty())
-        path = ".";
-    return getItem(path);
-}
-
-int CMainWindow::getNumDirs(const QString& dir, QProgressDialog * dlg ) const
-{
-    qApp->processEvents();
-    QDirIterator ii(dir, QStringList() << "*.*" << "*", QDir::Filter::AllDirs | QDir::NoDotAndDotDot | QDir::NoSymLinks, QDirIterator::IteratorFlag::Subdirectories);
-
-    int cnt = 0;
-    while (ii.hasNext())
-    {
-        ii.next();
-        if (dlg->wasCanceled())
-            break;
-
-        if (skipDir(ii.fileName()))
-            continue;
-
-        if ( cnt % 100 == 0 )
-            qApp->processEvents();
-        cnt++;
-    }
-    return cnt;
-}
-
 void CMainWindow::slotTransform()
 {
+    TRACE_SCOPE( "rename", "CMainWindow::slotTransform" );
     QProgressDialog dlg(tr("Computing Number of Directories to Rename..."), "Cancel", 0, 0, this);
     dlg.setMinimumDuration(0);
     dlg.setValue(1);
@@ -339,7 +480,7 @@ int CMainWindow::getNumDirsToRename( QProgressDialog * dlg, QTreeWidgetItem * pa
     if (dlg->wasCanceled())
         return 0;
 
-    int retVal = (parent && ( parent->type() == ENodeType::eOKDirToRename ) ) ? 1 : 0;
+    int retVal = (parent && willRename(parent)) ? 1 : 0;
 
     for (int ii = 0; ii < (parent ? parent->childCount() : fImpl->directories->topLevelItemCount() ); ++ii )
     {
@@ -362,7 +503,7 @@ void CMainWindow::transform( QTreeWidgetItem * item, int pos, QProgressDialog *
 
     if (!item)
         return;
-    if ( item->type() == ENodeType::eOKDirToRename )
+    if (willRename(item))
     {
         auto lhsRelToDir = QDir(fImpl->lhsDir->text());
         auto lhsRelPath = item->text(0);
@@ -376,7 +517,7 @@ void CMainWindow::transform( QTreeWidgetItem * item, int pos, QProgressDialog *
         auto newRhsAbsPath = QDir(rhsRelToDir.absoluteFilePath(lhsPath)).absoluteFilePath(newDirName);
         auto newRhsRelPath = rhsRelToDir.relativeFilePath(newRhsAbsPath);
 
-        qDebug() << "Renaming " << oldRhsAbsPath << " to " << newRhsAbsPath;
+        LOG_INFO( sRenameLog, "Renaming %1 to %2", oldRhsAbsPath, newRhsAbsPath );
 
         if ( !QFile::rename( oldRhsAbsPath, newRhsAbsPath ) )
         {
@@ -388,7 +529,8 @@ void CMainWindow::transform( QTreeWidgetItem * item, int pos, QProgressDialog *
             {
                 auto parent = item->parent();
                 parent->takeChild(pos);
-                item = new QTreeWidgetItem((QTreeWidgetItem*)nullptr, QStringList() << item->text( 0 ) << newRhsRelPath, eParentDir);
+                item = new QTreeWidgetItem((QTreeWidgetItem*)nullptr, QStringList() << item->text( 0 ) << newRhsRelPath);
+                item->setData(0, kNodeTypeRole, eParentDir);
                 parent->insertChild(pos, item);
             }
         }
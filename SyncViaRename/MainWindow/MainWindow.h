@@ -26,7 +26,16 @@
 class QTreeWidgetItem;
 class QFileInfo;
 class QProgressDialog;
+class CScanStatsPanel;
+class QTimer;
+class QPushButton;
+class CRHSIndex;
+#include "Common/BatchQueue.h"
 #include <QMainWindow>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
 
 namespace Ui {class CMainWindow;};
 
@@ -40,34 +49,63 @@ public:
         eOK,
         eMissingDir,
         eOKDirToRename,
-        eBadFileName
+        eBadFileName,
+        eFuzzyDirToRename, // the RHS name is close to the LHS title, but not the same
+        ePending // found before the RHS index was ready, updated in place once it is classified
     };
+    static constexpr int kNodeTypeRole = Qt::UserRole; // an item's type is fixed at construction, a pending row's is not
 
     CMainWindow(QWidget* parent = 0);
     ~CMainWindow();
+Q_SIGNALS:
+    void sigLoadFinished();
 public Q_SLOTS:
     void slotSelectRHSDirectory();
     void slotSelectLHSDirectory();
     void slotDirectoryChanged();
     void slotLoad();
     void slotTransform();
+private Q_SLOTS:
+    void slotShowFound();
+    void slotCancelLoad();
 private:
+    struct SFoundDir
+    {
+        QString fRelPath;
+        ENodeType fType;
+        QString fRHSRelPath; // the RHS directory it corresponds to, empty when there is none
+    };
+
     void loadSettings();
     void saveSettings();
     void loadDirectory();
-
-    bool hasChildDirs(const QFileInfo& lhsInfo ) const;
+    void stopLoading();
+    void setLoading(bool loading);
+    // runs on the load task, only reads skipDir and fCanceled
+    void findDirs(const QString& lhsDir, const QString& rhsDir, CBatchQueue< SFoundDir >& found) const;
+    static SFoundDir classify(const QString& relPath, bool hasChildDirs, const CRHSIndex& rhsIndex);
+    void addDirItem(const SFoundDir& dir);
+    void addRHSClaim(const QString& rhsRelPath, QTreeWidgetItem* item);
+    static ENodeType nodeType(const QTreeWidgetItem* item);
+    // an exact match, or a checked close one, whose RHS directory no other LHS directory claims
+    bool willRename(const QTreeWidgetItem* item) const;
 
     bool skipDir(const QString& path) const;
     void transform(QTreeWidgetItem* item, int pos, QProgressDialog * dlg);
 
-    int getNumDirs( const QString & dir, QProgressDialog * dlg ) const;
     int getNumDirsToRename(QProgressDialog* dlg, QTreeWidgetItem* parent = nullptr) const;
 
     QTreeWidgetItem* getItem(const QString & info) const;
-    QTreeWidgetItem* getParent(const QFileInfo& info) const;
 
     std::unordered_map< QString, QTreeWidgetItem* > fDirMap;
+    std::unordered_map< QString, std::vector< QTreeWidgetItem* > > fRHSClaims; // by RHS relative path, the LHS items pointing at it
+    CScanStatsPanel* fStatsPanel{ nullptr };
+
+    std::shared_ptr< CBatchQueue< SFoundDir > > fFound;
+    std::future< void > fLoadTask;
+    std::atomic< bool > fCanceled{ false };
+    QTimer* fLoadTimer{ nullptr };
+    QPushButton* fCancelLoad{ nullptr };
 
     std::unique_ptr< Ui::CMainWindow > fImpl;
 };
@@ -0,0 +1,164 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RHSIndex.h"
+#include "Common/Trace.h"
+#include "Common/ScanStats.h"
+#include "Common/DirWalker.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QThread>
+#include <algorithm>
+#include <future>
+#include <vector>
+
+bool CRHSIndex::load( const QString & rootDir, const std::atomic< bool > & canceled )
+{
+    TRACE_SCOPE( "scan", "CRHSIndex::load" );
+    SCAN_PHASE( "rhs index" );
+    fPaths.clear();
+    fByTitle.clear();
+    fChildTitles.clear();
+
+    auto relToDir = QDir( rootDir );
+    std::vector< QString > topLevel;
+    std::vector< NDirWalker::SEntry > entries;
+    NDirWalker::readDir( relToDir.absolutePath(), entries );
+    for ( auto && ii : entries )
+    {
+        if ( ii.fIsDir )
+            topLevel.push_back( NDirWalker::filePath( relToDir.absolutePath(), ii ) );
+    }
+
+    // a library's top level is usually a handful of large trees, each is walked by whichever task is free
+    std::vector< std::vector< QString > > subDirs( topLevel.size() );
+    std::atomic< size_t > next{ 0 };
+    std::vector< std::future< void > > tasks;
+    auto numTasks = std::max( 1, std::min( QThread::idealThreadCount(), static_cast< int >( topLevel.size() ) ) );
+    for ( int ii = 0; ii < numTasks; ++ii )
+    {
+        tasks.push_back( std::async( std::launch::async, [ &topLevel, &subDirs, &next, &canceled ]()
+            {
+                TRACE_SCOPE( "scan", "CRHSIndex::load walk" );
+                std::vector< NDirWalker::SEntry > dirEntries;
+                for ( auto jj = next++; ( jj < topLevel.size() ) && !canceled; jj = next++ )
+                {
+                    // the listing says which entries are directories, nothing is stat'ed
+                    std::vector< QString > pending{ topLevel[ jj ] };
+                    while ( !pending.empty() && !canceled )
+                    {
+                        auto dirPath = std::move( pending.back() );
+                        pending.pop_back();
+                        NDirWalker::readDir( dirPath, dirEntries );
+                        for ( auto && kk : dirEntries )
+                        {
+                            if ( !kk.fIsDir )
+                                continue;
+                            subDirs[ jj ].push_back( NDirWalker::filePath( dirPath, kk ) );
+                            pending.push_back( subDirs[ jj ].back() );
+                        }
+                    }
+                }
+            } ) );
+    }
+    for ( auto && ii : tasks )
+        ii.wait();
+    if ( canceled )
+        return false;
+
+    for ( size_t ii = 0; ii < topLevel.size(); ++ii )
+    {
+        add( relToDir.relativeFilePath( topLevel[ ii ] ) );
+        for ( auto && jj : subDirs[ ii ] )
+            add( relToDir.relativeFilePath( jj ) );
+    }
+    return true;
+}
+
+void CRHSIndex::add( const QString & relPath )
+{
+    static thread_local QRegularExpression sYearRegExp( "^(?<title>.*)\\s*\\((?<year>\\d{4})\\)$" );
+
+    fPaths.insert( relPath );
+
+    QFileInfo fi( relPath );
+    auto leafName = fi.fileName();
+    NScanStats::add( NScanStats::eRegexEvals );
+    auto match = sYearRegExp.match( leafName );
+    auto title = match.hasMatch() ? match.captured( "title" ) : leafName;
+    auto year = match.hasMatch() ? match.captured( "year" ) : QString();
+    fByTitle.emplace( titleKey( fi.path(), title, year ), relPath );
+
+    auto && children = fChildTitles[ fi.path() ];
+    children.fMatcher.add( title );
+    children.fDirs.emplace_back( relPath, year );
+}
+
+bool CRHSIndex::contains( const QString & relPath ) const
+{
+    return fPaths.find( relPath ) != fPaths.end();
+}
+
+QString CRHSIndex::find( const QString & parentRelPath, const QString & baseName, const QString & year ) const
+{
+    auto pos = fByTitle.find( titleKey( parentRelPath, baseName, QString() ) );
+    if ( ( pos == fByTitle.end() ) && !year.isEmpty() )
+        pos = fByTitle.find( titleKey( parentRelPath, baseName, year ) );
+    if ( pos == fByTitle.end() )
+        return QString();
+    return ( *pos ).second;
+}
+
+QString CRHSIndex::findClosest( const QString & parentRelPath, const QString & baseName, const QString & year ) const
+{
+    auto pos = fChildTitles.find( parentRelPath );
+    if ( pos == fChildTitles.end() )
+        return QString();
+
+    // only the same year lets the titles differ, without one on both sides to confirm it the title has to be the same
+    auto && children = ( *pos ).second;
+    auto normalized = CTitleMatcher::normalize( baseName );
+    auto match = children.fMatcher.find( baseName,
+        [ &children, &year, &normalized ]( int index )
+        {
+            auto && dirYear = children.fDirs[ index ].second;
+            if ( !dirYear.isEmpty() && ( dirYear == year ) )
+                return true;
+            return children.fMatcher.title( index ) == normalized;
+        } );
+    if ( match.fIndex < 0 )
+        return QString();
+    return children.fDirs[ match.fIndex ].first;
+}
+
+QString CRHSIndex::normalizedTitle( const QString & title )
+{
+    return title.simplified().toLower();
+}
+
+QString CRHSIndex::titleKey( const QString & parentRelPath, const QString & title, const QString & year )
+{
+    // '/' can't appear in a directory name, so the parts can't run into each other
+    return parentRelPath + "/" + normalizedTitle( title ) + "/" + year;
+}
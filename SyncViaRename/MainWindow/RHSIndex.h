@@ -0,0 +1,71 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _RHSINDEX_H
+#define _RHSINDEX_H
+
+#include "TitleMatcher.h"
+
+#include <QString>
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// The RHS tree read in one walk, so an LHS directory is matched with hash lookups rather than by stat'ing
+// each candidate path.  Directories are kept by relative path, and by their parent's relative path plus the
+// normalized title and year of their name, "Title" or "Title (Year)"
+class CRHSIndex
+{
+public:
+    // the top level directories are walked concurrently, returns false when canceled
+    bool load( const QString & rootDir, const std::atomic< bool > & canceled );
+
+    bool contains( const QString & relPath ) const;
+    // the RHS directory named "baseName", or failing that "baseName (year)", under parentRelPath.  Empty when there is neither
+    QString find( const QString & parentRelPath, const QString & baseName, const QString & year ) const;
+    // the RHS directory under parentRelPath whose title is closest to baseName, see CTitleMatcher.  Only one of
+    // the same year may differ in title, when the years differ or either is missing the normalized titles must be
+    // equal.  Empty when nothing is close enough
+    QString findClosest( const QString & parentRelPath, const QString & baseName, const QString & year ) const;
+
+    size_t size() const { return fPaths.size(); }
+
+    // lower case, with runs of white space collapsed
+    static QString normalizedTitle( const QString & title );
+private:
+    void add( const QString & relPath );
+    static QString titleKey( const QString & parentRelPath, const QString & title, const QString & year );
+
+    std::unordered_set< QString > fPaths;
+    std::unordered_map< QString, QString > fByTitle;
+
+    struct SChildTitles
+    {
+        CTitleMatcher fMatcher;
+        std::vector< std::pair< QString, QString > > fDirs; // relative path and year, in the matcher's order
+    };
+    std::unordered_map< QString, SChildTitles > fChildTitles; // by the parent's relative path
+};
+
+#endif
@@ -0,0 +1,280 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "TitleMatcher.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <memory>
+#include <utility>
+
+namespace
+{
+    const int kGramSize = 3;
+    const QChar kGramPad( 1 );
+
+    // the pattern side of the bit-parallel edit distance, one bit per pattern position for every character
+    class CPatternMasks
+    {
+    public:
+        CPatternMasks( const QString & pattern )
+        {
+            fAscii.fill( 0 );
+            for ( int ii = 0; ii < pattern.length(); ++ii )
+                mask( pattern[ ii ].unicode() ) |= ( quint64( 1 ) << ii );
+        }
+
+        quint64 get( ushort ch ) const
+        {
+            if ( ch < fAscii.size() )
+                return fAscii[ ch ];
+            for ( auto && ii : fOther )
+            {
+                if ( ii.first == ch )
+                    return ii.second;
+            }
+            return 0;
+        }
+    private:
+        quint64 & mask( ushort ch )
+        {
+            if ( ch < fAscii.size() )
+                return fAscii[ ch ];
+            for ( auto && ii : fOther )
+            {
+                if ( ii.first == ch )
+                    return ii.second;
+            }
+            fOther.emplace_back( ch, 0 );
+            return fOther.back().second;
+        }
+
+        std::array< quint64, 128 > fAscii;
+        std::vector< std::pair< ushort, quint64 > > fOther;
+    };
+
+    // Myers' algorithm in Hyyrö's form for the distance between whole strings.  The pattern must be 1 to 64 long
+    int bitParallelDistance( const CPatternMasks & masks, int patternLength, const QString & text, int maxDistance )
+    {
+        quint64 pv = ~quint64( 0 );
+        quint64 mv = 0;
+        quint64 lastBit = quint64( 1 ) << ( patternLength - 1 );
+        int score = patternLength;
+        int textLength = text.length();
+        for ( int ii = 0; ii < textLength; ++ii )
+        {
+            auto eq = masks.get( text[ ii ].unicode() );
+            auto xv = eq | mv;
+            auto xh = ( ( ( eq & pv ) + pv ) ^ pv ) | eq;
+            auto ph = mv | ~( xh | pv );
+            auto mh = pv & xh;
+            if ( ph & lastBit )
+                ++score;
+            else if ( mh & lastBit )
+                --score;
+
+            // every remaining column can lower the score by one at most
+            if ( ( score - ( textLength - ii - 1 ) ) > maxDistance )
+                return maxDistance + 1;
+
+            ph = ( ph << 1 ) | 1; // the top row grows by one per column
+            mh <<= 1;
+            pv = mh | ~( xv | ph );
+            mv = ph & xv;
+        }
+        return std::min( score, maxDistance + 1 );
+    }
+
+    // the plain two row table, for patterns longer than a word
+    int tableDistance( const QString & pattern, const QString & text, int maxDistance )
+    {
+        std::vector< int > prev( pattern.length() + 1 );
+        std::vector< int > curr( pattern.length() + 1 );
+        for ( int ii = 0; ii <= pattern.length(); ++ii )
+            prev[ ii ] = ii;
+
+        for ( int jj = 1; jj <= text.length(); ++jj )
+        {
+            curr[ 0 ] = jj;
+            int rowMin = curr[ 0 ];
+            for ( int ii = 1; ii <= pattern.length(); ++ii )
+            {
+                int cost = ( pattern[ ii - 1 ] == text[ jj - 1 ] ) ? 0 : 1;
+                curr[ ii ] = std::min( { prev[ ii ] + 1, curr[ ii - 1 ] + 1, prev[ ii - 1 ] + cost } );
+                rowMin = std::min( rowMin, curr[ ii ] );
+            }
+            if ( rowMin > maxDistance )
+                return maxDistance + 1;
+            std::swap( prev, curr );
+        }
+        return std::min( prev[ pattern.length() ], maxDistance + 1 );
+    }
+}
+
+int CTitleMatcher::add( const QString & title )
+{
+    auto index = static_cast< int >( fTitles.size() );
+    fTitles.push_back( normalize( title ) );
+    for ( auto && ii : distinctGrams( fTitles.back() ) )
+        fGrams[ ii ].push_back( index );
+    return index;
+}
+
+CTitleMatcher::SMatch CTitleMatcher::find( const QString & title, const std::function< bool( int index ) > & accept ) const
+{
+    SMatch retVal;
+    auto normalized = normalize( title );
+    auto length = normalized.length();
+    if ( length == 0 )
+        return retVal;
+    auto allowed = maxDistance( length );
+
+    // A title within k edits shares at least (distinct 3-grams - 3k) of them, every edit breaks 3 at most.
+    // The counts are kept per thread and only the touched ones are cleared, so a lookup costs the postings it reads
+    static thread_local std::vector< int > sCounts;
+    static thread_local std::vector< int > sTouched;
+    sCounts.resize( std::max( sCounts.size(), fTitles.size() ) );
+    sTouched.clear();
+
+    auto grams = distinctGrams( normalized );
+    int threshold = static_cast< int >( grams.size() ) - kGramSize * allowed;
+    std::vector< int > candidates;
+    if ( threshold <= 0 )
+    {
+        // too short for the grams to rule anything out
+        candidates.resize( fTitles.size() );
+        for ( int ii = 0; ii < static_cast< int >( fTitles.size() ); ++ii )
+            candidates[ ii ] = ii;
+    }
+    else
+    {
+        for ( auto && ii : grams )
+        {
+            auto pos = fGrams.find( ii );
+            if ( pos == fGrams.end() )
+                continue;
+            for ( auto && jj : ( *pos ).second )
+            {
+                if ( sCounts[ jj ]++ == 0 )
+                    sTouched.push_back( jj );
+            }
+        }
+        for ( auto && ii : sTouched )
+        {
+            if ( sCounts[ ii ] >= threshold )
+                candidates.push_back( ii );
+            sCounts[ ii ] = 0;
+        }
+        std::sort( candidates.begin(), candidates.end() );
+    }
+
+    std::unique_ptr< CPatternMasks > masks;
+    if ( length <= 64 )
+        masks = std::make_unique< CPatternMasks >( normalized );
+    for ( auto && ii : candidates )
+    {
+        auto && candidate = fTitles[ ii ];
+        if ( std::abs( candidate.length() - length ) > allowed )
+            continue;
+
+        auto distance = masks ? bitParallelDistance( *masks, length, candidate, allowed ) : tableDistance( normalized, candidate, allowed );
+        if ( distance > allowed )
+            continue;
+        if ( accept && !accept( ii ) )
+            continue;
+
+        retVal.fIndex = ii;
+        retVal.fDistance = distance;
+        if ( distance == 0 )
+            break;
+        allowed = distance - 1; // only a strictly closer title can replace it
+    }
+    return retVal;
+}
+
+QString CTitleMatcher::normalize( const QString & title )
+{
+    // accents are split off their letters and dropped, everything else that isn't a letter or digit separates words
+    auto decomposed = title.normalized( QString::NormalizationForm_KD ).toLower();
+    decomposed.replace( "&", " and " );
+    QString retVal;
+    retVal.reserve( decomposed.length() );
+    for ( auto && ii : decomposed )
+    {
+        if ( ii.isMark() )
+            continue;
+        retVal += ii.isLetterOrNumber() ? ii : QChar( ' ' );
+    }
+    retVal = retVal.simplified();
+
+    // only an article moved behind a comma is dropped from the end, "Movie, The".  "Plan A" keeps its A
+    auto compact = decomposed.simplified().remove( ' ' );
+    for ( auto && ii : { QString( "the" ), QString( "a" ), QString( "an" ) } )
+    {
+        if ( retVal.startsWith( ii + " " ) )
+            retVal = retVal.mid( ii.length() + 1 );
+        else if ( retVal.endsWith( " " + ii ) && compact.endsWith( "," + ii ) )
+            retVal.chop( ii.length() + 1 );
+        else
+            continue;
+        break;
+    }
+    return retVal;
+}
+
+int CTitleMatcher::maxDistance( int length )
+{
+    return length / 5;
+}
+
+int CTitleMatcher::editDistance( const QString & lhs, const QString & rhs, int maxDistance )
+{
+    // the shorter one is the pattern, so more of them fit in a word
+    auto && pattern = ( lhs.length() <= rhs.length() ) ? lhs : rhs;
+    auto && text = ( lhs.length() <= rhs.length() ) ? rhs : lhs;
+    if ( pattern.isEmpty() )
+        return std::min( text.length(), maxDistance + 1 );
+    if ( ( text.length() - pattern.length() ) > maxDistance )
+        return maxDistance + 1;
+    if ( pattern.length() > 64 )
+        return tableDistance( pattern, text, maxDistance );
+    return bitParallelDistance( CPatternMasks( pattern ), pattern.length(), text, maxDistance );
+}
+
+std::vector< quint64 > CTitleMatcher::distinctGrams( const QString & normalized )
+{
+    // padded, so the start and end of the title have grams of their own
+    QString padded = QString( kGramSize - 1, kGramPad ) + normalized + QString( kGramSize - 1, kGramPad );
+    std::vector< quint64 > retVal;
+    retVal.reserve( padded.length() );
+    for ( int ii = 0; ii + kGramSize <= padded.length(); ++ii )
+    {
+        quint64 gram = 0;
+        for ( int jj = 0; jj < kGramSize; ++jj )
+            gram = ( gram << 16 ) | padded[ ii + jj ].unicode();
+        retVal.push_back( gram );
+    }
+    std::sort( retVal.begin(), retVal.end() );
+    retVal.erase( std::unique( retVal.begin(), retVal.end() ), retVal.end() );
+    return retVal;
+}
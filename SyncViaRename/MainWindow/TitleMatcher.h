@@ -0,0 +1,68 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _TITLEMATCHER_H
+#define _TITLEMATCHER_H
+
+#include <QString>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// Finds the closest of a set of titles to a given one, for names that differ by more than case, eg
+// "Movie, The" and "The Movie", stray punctuation or doubled spaces.
+//
+// Titles are normalized, and then compared by edit distance.  No title is compared with all of the others.
+// Each title's 3-grams are indexed, and only titles sharing enough of them to be within the allowed
+// distance are scored.  The scoring is the bit-parallel edit distance, 64 columns of the table per step
+class CTitleMatcher
+{
+public:
+    struct SMatch
+    {
+        int fIndex{ -1 }; // into the order the titles were added, -1 when nothing is close enough
+        int fDistance{ 0 };
+    };
+
+    // returns the index of the title
+    int add( const QString & title );
+    // the closest title within maxDistance edits of the normalized title, ties go to the first added.
+    // When given, accept can reject a candidate, eg one from a different year
+    SMatch find( const QString & title, const std::function< bool( int index ) > & accept = {} ) const;
+
+    size_t size() const { return fTitles.size(); }
+    const QString & title( int index ) const { return fTitles[ index ]; } // normalized
+
+    // lower case, accents, punctuation, a leading article and a trailing ", The" removed, runs of white space collapsed
+    static QString normalize( const QString & title );
+    // the edits allowed between two titles, a fifth of the length
+    static int maxDistance( int length );
+    // the Levenshtein distance, or maxDistance + 1 once it is known to be larger
+    static int editDistance( const QString & lhs, const QString & rhs, int maxDistance );
+private:
+    static std::vector< quint64 > distinctGrams( const QString & normalized );
+
+    std::vector< QString > fTitles; // normalized
+    std::unordered_map< quint64, std::vector< int > > fGrams; // 3-gram, the titles containing it
+};
+
+#endif
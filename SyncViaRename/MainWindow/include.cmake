@@ -22,6 +22,8 @@
 
 set(qtproject_SRCS
     MainWindow.cpp
+    RHSIndex.cpp
+    TitleMatcher.cpp
 )
 
 set(qtproject_H
@@ -29,6 +31,8 @@ set(qtproject_H
 )
 
 set(project_H
+    RHSIndex.h
+    TitleMatcher.h
 )
 
 set(qtproject_UIS
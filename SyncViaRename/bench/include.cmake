@@ -0,0 +1,22 @@
+set(qtproject_SRCS
+    main.cpp
+)
+
+set(qtproject_H
+)
+
+set(project_H
+)
+
+set(qtproject_UIS
+)
+
+
+set(qtproject_QRC
+)
+
+set( project_pub_DEPS
+        SABUtils
+        MediaToolsCommon
+        SyncViaRenameMainWindow
+)
@@ -0,0 +1,93 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2022 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "MainWindow/MainWindow.h"
+#include "MainWindow/TitleMatcher.h"
+#include "Common/Benchmark.h"
+
+#include <QApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QRegularExpression>
+
+int main( int argc, char ** argv )
+{
+    CBenchmark::setHeadless();
+    Q_INIT_RESOURCE( application );
+    QApplication appl( argc, argv );
+    appl.setApplicationName( "SyncViaRenameBench" );
+    appl.setOrganizationName( "Scott Aron Bloom" );
+    appl.setOrganizationDomain( "www.towel42.com" );
+
+    CBenchmark bench( "Times the SyncViaRename directory load on synthetic libraries" );
+    bench.process( appl );
+
+    CMainWindow mainWindow;
+    appl.processEvents(); // the constructor's delayed directory check
+
+    // both sides are the same library, so every directory has a match
+    bench.addCase( "CMainWindow::slotLoad",
+        [ &mainWindow ]( const QString & rootDir, QString & errorMsg )
+        {
+            if ( !CBenchmark::setDirectory( &mainWindow, "lhsDir", rootDir, errorMsg ) || !CBenchmark::setDirectory( &mainWindow, "rhsDir", rootDir, errorMsg ) )
+                return false;
+            return runUntilSignal( &mainWindow, &CMainWindow::sigLoadFinished, [ &mainWindow ]() { mainWindow.slotLoad(); }, errorMsg );
+        } );
+
+    // every directory title against the set of all of them drifted the way RHS names do, ", The" moved, the
+    // year dropped and the last letter lost.  Listing the tree and indexing the drifted titles are timed too
+    bench.addCase( "CTitleMatcher::find",
+        []( const QString & rootDir, QString & errorMsg )
+        {
+            QRegularExpression regExp( "^(?<basename>.*)\\s*\\((?<year>\\d{4})\\)" );
+            QStringList titles;
+            QDirIterator ii( rootDir, QDir::AllDirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories );
+            while ( ii.hasNext() )
+            {
+                ii.next();
+                auto match = regExp.match( ii.fileName() );
+                if ( match.hasMatch() )
+                    titles << match.captured( "basename" ).trimmed();
+            }
+
+            CTitleMatcher matcher;
+            for ( auto && ii : titles )
+            {
+                auto drifted = ii.startsWith( "The " ) ? ( ii.mid( 4 ) + ", The" ) : ii;
+                matcher.add( drifted.left( drifted.length() - 1 ) );
+            }
+
+            int found = 0;
+            for ( auto && ii : titles )
+            {
+                if ( matcher.find( ii ).fIndex >= 0 )
+                    ++found;
+            }
+            if ( found < titles.count() / 2 )
+            {
+                errorMsg = QString( "Only %1 of %2 titles were matched" ).arg( found ).arg( titles.count() );
+                return false;
+            }
+            return true;
+        } );
+    return bench.run();
+}